@@ -1,4 +1,5 @@
 #include "ReutersArticle.h"
+#include <algorithm>
 
 namespace dis
 {
@@ -15,11 +16,64 @@ namespace dis
         parse_article();
     }
 
+    ReutersArticle::ReutersArticle(const DocId id, std::vector<AsciiTextView> &articleLines, std::vector<AsciiTextView> &textLines)
+    {
+        m_docId = id;
+        m_articleLines = std::move(articleLines);
+        m_articleTextLines = std::move(textLines);
+        parse_article_metadata();
+    }
+
+    static std::string_view tag_content(std::string_view text, std::string_view openTag, std::string_view closeTag)
+    {
+        const size_t from = text.find(openTag);
+        if (from == std::string_view::npos)
+            return {};
+        text.remove_prefix(from + openTag.length());
+        return text.substr(0, text.find(closeTag));
+    }
+
+    static std::vector<std::string> tag_values(std::string_view text)
+    {
+        std::vector<std::string> values;
+        for (size_t from = text.find("<D>"); from != std::string_view::npos; from = text.find("<D>"))
+        {
+            text.remove_prefix(from + 3);
+            const size_t to = text.find("</D>");
+            values.emplace_back(text.substr(0, to));
+            if (to == std::string_view::npos)
+                break;
+            text.remove_prefix(to + 4);
+        }
+        return values;
+    }
+
+    void ReutersArticle::parse_metadata(const std::string_view line)
+    {
+        if (line.substr(0, 6) == "<DATE>")
+            m_metadata.date = parse_reuters_date(tag_content(line, "<DATE>", "</DATE>"));
+        else if (line.substr(0, 8) == "<TOPICS>")
+            m_metadata.topics = tag_values(line);
+        else if (line.substr(0, 8) == "<PLACES>")
+            m_metadata.places = tag_values(line);
+        else if (m_metadata.title.empty() && (line.find("<TITLE>") != std::string_view::npos))
+            m_metadata.title = std::string(tag_content(line, "<TITLE>", "</TITLE>"));
+    }
+
+    void ReutersArticle::parse_article_metadata()
+    {
+        for (const auto &line : m_articleLines)
+        {
+            parse_metadata(line.string_view());
+        }
+    }
+
     void ReutersArticle::parse_article()
     {
         bool insideText = false;
         for (size_t line = 0; line < m_articleLines.size(); ++line)
         {
+            parse_metadata(m_articleLines[line].string_view());
             if (m_articleLines[line].starts_with("<TEXT"))
             {
                 insideText = true;
@@ -37,57 +91,120 @@ namespace dis
         }
     }
 
-    void ReutersArticle::filter_article_text(const std::vector<azgra::string::SmartStringView<char>> &stopwords)
+    bool ReutersArticle::text_lines_are_contiguous() const
     {
-        std::stringstream articleStream;
-        for (const auto &line : m_articleTextLines)
+        for (size_t i = 1; i < m_articleTextLines.size(); ++i)
         {
-            filter_line(articleStream, line, stopwords);
-            articleStream << '\n';
+            const char *previousEnd = m_articleTextLines[i - 1].data() + m_articleTextLines[i - 1].length();
+            if ((previousEnd + 1) != m_articleTextLines[i].data() || *previousEnd != '\n')
+                return false;
         }
-        m_processedText = articleStream.str();
-        m_processedWords = azgra::string::SmartStringView<char>(m_processedText.c_str()).multi_split({' ', '\n'});
+        return true;
     }
 
-    void ReutersArticle::extract_filtered_article_text(std::stringstream &textStream,
-                                                       const std::vector<AsciiTextView> &stopwords) const
+    template<typename StemCallback, typename LineEndCallback>
+    void ReutersArticle::for_each_stem(const StopwordSet &stopwords, StemCallback &&stemCallback,
+                                       LineEndCallback &&lineEndCallback) const
     {
-        textStream << "\n-------- ARTICLE --------\n";
+        if (m_articleTextLines.empty())
+            return;
 
-        for (const auto &line : m_articleTextLines)
+        std::string stemBuffer;
+        const auto onToken = [&stopwords, &stemBuffer, &stemCallback](const char *token, const size_t tokenLength)
         {
-            filter_line(textStream, line, stopwords);
-            textStream << '\n';
+            if (!stopwords.contains(token, tokenLength))
+            {
+                stemCallback(cached_stem_word(token, tokenLength, stemBuffer));
+            }
+        };
+
+        if (!text_lines_are_contiguous())
+        {
+            for (const auto &line : m_articleTextLines)
+            {
+                tokenize_line(line.data(), line.length(), onToken);
+                lineEndCallback();
+            }
+            return;
         }
 
-        textStream << "------- END OF ARTICLE -----\n";
+        // Lines of mapped or streamed files lie in one buffer, the whole body is normalized in one pass.
+        const char *bodyBegin = m_articleTextLines.front().data();
+        const char *bodyEnd = m_articleTextLines.back().data() + m_articleTextLines.back().length();
+        tokenize_text(bodyBegin, static_cast<size_t>(bodyEnd - bodyBegin), onToken, lineEndCallback);
+        lineEndCallback();
     }
 
-    void ReutersArticle::filter_line(std::stringstream &ss, const ReutersArticle::AsciiTextView &line,
-                                     const std::vector<AsciiTextView> &stopwords) const
+    void ReutersArticle::filter_article_text(const StopwordSet &stopwords, TermDictionary &dictionary,
+                                             const ArticleFilterOptions &options)
     {
-        std::stringstream lineStream;
-        for (const auto &c : line)
+        // Terms are counted while the text is tokenized, the stemmed text isn't built unless somebody asks for it.
+        thread_local ArticleTermCounter termCounter;
+        termCounter.clear();
+
+        m_processedText.clear();
+        if (options.keepProcessedText)
         {
-            if ((c >= 'a' && c <= 'z') || (c == ' ') || (c >= '0' && c <= '9'))
-                lineStream << c;
-            else if (c >= 'A' && c <= 'Z')
-                lineStream << static_cast<char>(c + LowerCaseOffset);
-            else if (c == '<' || c == '>' || c == '/' || c == '\\' || c == '.' || c == '-') // Force word separation at some characters
-                lineStream << ' ';
+            // Stems are never longer than the words and every word is followed by one separator.
+            size_t textLength = 0;
+            for (const auto &line : m_articleTextLines)
+            {
+                textLength += line.length() + 2;
+            }
+            m_processedText.reserve(textLength);
         }
-        const auto lineString = lineStream.str();
-        const auto words = azgra::string::SmartStringView<char>(lineString.c_str()).split(' ');
-        for (const auto word : words)
+        else
         {
-            if (word.is_empty())
-                continue;
-            if (!azgra::collection::contains(stopwords.begin(), stopwords.end(), word))
+            m_processedText.shrink_to_fit();
+        }
+
+        azgra::u32 position = 0;
+        const auto onStem = [&](const std::string_view &stem)
+        {
+            if (options.keepProcessedText)
             {
-                AsciiString str = stem_word(word.data(), word.length());
-                ss << str.get_c_string() << ' ';
+                m_processedText.append(stem);
+                m_processedText.push_back(' ');
             }
-        }
+            if (is_term(stem.data(), stem.length()))
+            {
+                termCounter.add(stem.data(), stem.length(), position, options.recordPositions);
+            }
+            ++position;
+        };
+        const auto onLineEnd = [&]()
+        {
+            if (options.keepProcessedText)
+                m_processedText.push_back('\n');
+        };
+        for_each_stem(stopwords, onStem, onLineEnd);
+
+        termCounter.emit(dictionary, m_termFrequencies, m_termPositions);
+    }
+
+    void ReutersArticle::extract_filtered_article_text(std::stringstream &textStream,
+                                                       const StopwordSet &stopwords) const
+    {
+        std::string articleText;
+        filter_text_lines(articleText, stopwords);
+
+        textStream << "\n-------- ARTICLE --------\n";
+        textStream << articleText;
+        textStream << "------- END OF ARTICLE -----\n";
+    }
+
+    void ReutersArticle::filter_text_lines(std::string &text, const StopwordSet &stopwords) const
+    {
+        const auto onStem = [&text](const std::string_view &stem)
+        {
+            text.append(stem);
+            text.push_back(' ');
+        };
+        const auto onLineEnd = [&text]()
+        {
+            text.push_back('\n');
+        };
+        for_each_stem(stopwords, onStem, onLineEnd);
     }
 
     std::string const &ReutersArticle::get_processed_string() const
@@ -95,6 +212,16 @@ namespace dis
         return m_processedText;
     }
 
+    const std::vector<TermFrequency> &ReutersArticle::get_term_frequencies() const
+    {
+        return m_termFrequencies;
+    }
+
+    const std::vector<ReutersArticle::AsciiTextView> &ReutersArticle::get_text_lines() const
+    {
+        return m_articleTextLines;
+    }
+
     void ReutersArticle::destroy_views()
     {
         m_articleLines.clear();
@@ -103,76 +230,42 @@ namespace dis
 
     void ReutersArticle::index_article_terms(TermIndex &index) const
     {
-        std::map<std::string, size_t> articleTerms;
-        std::string key;
-        for (const auto &word : m_processedWords)
-        {
-            if (!is_term(word))
-                continue;
-
-            key = std::string(word.string_view());
-            if (articleTerms.find(key) == articleTerms.end())
-            {
-                articleTerms[key] = 1;
-            }
-            else
-            {
-                articleTerms[key] += 1;
-            }
-        }
-
-        for (const auto&[key, occurenceCount] : articleTerms)
+        const bool withPositions = !m_termPositions.empty();
+        size_t positionOffset = 0;
+        for (const auto &[termId, frequency] : m_termFrequencies)
         {
-            if (index.find(key) == index.end())
+            if (withPositions)
             {
-                index[key] = {DocumentOccurence(m_docId, occurenceCount)};
+                index.add_occurence(termId, m_docId, m_termPositions.data() + positionOffset, frequency);
+                positionOffset += frequency;
             }
             else
             {
-                index[key].insert(DocumentOccurence(m_docId, occurenceCount));
+                index.add_occurence(termId, DocumentOccurence(m_docId, frequency));
             }
         }
-#if 0
-        std::string wordKey;
-        for (const auto &word : m_processedWords)
-        {
-            if (!is_term(word))
-                continue;
+    }
 
-            wordKey = std::string(word.string_view());
-            if (index.find(wordKey) == index.end())
-            {
-                // Creating new key in map.
-                index[wordKey] = {m_docOccurence};
-                //index[wordKey] = {m_docId};
-            }
-            else
-            {
-                // Key is already in map.
-
-                auto ocurrenceIt = index[wordKey].find(m_docOccurence);
-                // Wasnt yet found in this document.
-                if (ocurrenceIt == index[wordKey].end())
-                {
-                    // Key doesnt have entry of this document.
-                    index[wordKey].insert(m_docOccurence);
-                }
-                else
-                {
-                    // Key does have entry of this document.
-                    //(*index[wordKey].find(m_docOccurence)).occurenceCount++;
-                    //index[wordKey].insert(m_docId);
-                }
+    DocId ReutersArticle::get_docId() const
+    {
+        return m_docId;
+    }
 
+    void ReutersArticle::set_docId(const DocId id)
+    {
+        m_docId = id;
+    }
 
-            }
-        }
-#endif
+    const ArticleMetadata &ReutersArticle::get_metadata() const
+    {
+        return m_metadata;
     }
 
-    DocId ReutersArticle::get_docId() const
+    ArticleMetadata ReutersArticle::release_metadata()
     {
-        return m_docId;
+        ArticleMetadata metadata = std::move(m_metadata);
+        m_metadata = {};
+        return metadata;
     }
 
 
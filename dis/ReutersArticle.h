@@ -6,38 +6,79 @@
 #include <sstream>
 #include <azgra/collection/vector_linq.h>
 #include "porter_stemmer.h"
+#include "stem_cache.h"
+#include "tokenizer.h"
+#include "stopword_set.h"
+#include "article_metadata.h"
+#include "article_term_counter.h"
 
 namespace dis
 {
+    struct ArticleFilterOptions
+    {
+        /// Keep word positions of the terms for the positional index.
+        bool recordPositions = false;
+
+        /// Keep the stemmed text, only needed to save the preprocessed documents.
+        bool keepProcessedText = false;
+    };
+
     class ReutersArticle
     {
     private:
         typedef azgra::string::SmartStringView<char> AsciiTextView;
-        static constexpr char LowerCaseOffset = 'a' - 'A';
         std::vector<AsciiTextView> m_articleLines;
         std::vector<AsciiTextView> m_articleTextLines;
 
-        void filter_line(std::stringstream &ss, const AsciiTextView &line, const std::vector<AsciiTextView> &stopwords) const;
+        template<typename StemCallback, typename LineEndCallback>
+        void for_each_stem(const StopwordSet &stopwords, StemCallback &&stemCallback, LineEndCallback &&lineEndCallback) const;
+        void filter_text_lines(std::string &text, const StopwordSet &stopwords) const;
+        [[nodiscard]] bool text_lines_are_contiguous() const;
 
         void parse_article();
+        void parse_article_metadata();
+
+        void parse_metadata(const std::string_view line);
         std::string m_processedText;
-        std::vector<AsciiTextView> m_processedWords;
+        std::vector<TermFrequency> m_termFrequencies;
+        std::vector<azgra::u32> m_termPositions;
+        ArticleMetadata m_metadata;
         DocId m_docId;
 
     public:
         explicit ReutersArticle(const DocId id);
         explicit ReutersArticle(const DocId id, std::vector<AsciiTextView> &articleLines);
-        void filter_article_text(const std::vector<azgra::string::SmartStringView<char>> &stopwords);
+        /// Create article whose TEXT section lines were already found by the SGML scanner.
+        /// \param id Document id of the article.
+        /// \param articleLines All lines of the article, used for the metadata.
+        /// \param textLines Lines between the `<TEXT` line and the line with `</TEXT>`.
+        explicit ReutersArticle(const DocId id, std::vector<AsciiTextView> &articleLines, std::vector<AsciiTextView> &textLines);
+        /// Tokenize, filter and stem the article text and count its terms.
+        /// \param stopwords Stopwords removed from the text.
+        /// \param dictionary Dictionary assigning TermIds of the terms.
+        /// \param options Positions and processed text are kept only when requested.
+        void filter_article_text(const StopwordSet &stopwords, TermDictionary &dictionary, const ArticleFilterOptions &options = {});
 
-        void extract_filtered_article_text(std::stringstream &textStream, const std::vector<AsciiTextView> &stopwords) const;
+        void extract_filtered_article_text(std::stringstream &textStream, const StopwordSet &stopwords) const;
 
         [[nodiscard]] std::string const& get_processed_string() const;
 
+        [[nodiscard]] const std::vector<TermFrequency> &get_term_frequencies() const;
+
+        [[nodiscard]] const std::vector<AsciiTextView> &get_text_lines() const;
+
         void destroy_views();
 
         void index_article_terms(TermIndex &index) const;
 
         DocId get_docId() const;
+
+        void set_docId(const DocId id);
+
+        [[nodiscard]] const ArticleMetadata &get_metadata() const;
+
+        /// Move the metadata out of the article, used when the metadata are stored in the ArticleMetadataStore.
+        ArticleMetadata release_metadata();
     };
 
 }
@@ -1,31 +1,80 @@
+#include <cstring>
 #include <azgra/collection/enumerable.h>
 #include "SgmlFile.h"
 
 namespace dis
 {
-    SgmlFile SgmlFile::load(const char *fileName, DocId &docId)
+    SgmlFile SgmlFile::load(const char *fileName, DocId &docId, const bool memoryMapped)
     {
         SgmlFile file;
         file.m_fileName = fileName;
-        file.parse(docId);
+        file.parse(docId, memoryMapped);
         return file;
     }
 
-    void SgmlFile::parse(DocId &docId)
+    static std::vector<azgra::string::SmartStringView<char>> create_line_views(const char *data, const size_t size)
     {
-        m_lines = azgra::io::read_lines(m_fileName);
-        m_lineViews.resize(m_lines.size());
-        for (size_t i = 0; i < m_lines.size(); ++i)
+        // Views point directly into the data, the only allocation is the view vector itself.
+        const char *end = data + size;
+        size_t lineCount = 0;
+        for (const char *it = data; it < end; ++lineCount)
         {
-            m_lineViews[i] = azgra::string::SmartStringView<char>(m_lines[i]);
+            const char *newLine = static_cast<const char *>(memchr(it, '\n', end - it));
+            it = (newLine == nullptr) ? end : (newLine + 1);
         }
 
-        always_assert(m_lines[0] == "<!DOCTYPE lewis SYSTEM \"lewis.dtd\">" && "Wrong Sgml file header.");
-        load_articles(docId);
+        std::vector<azgra::string::SmartStringView<char>> lineViews(lineCount);
+        size_t line = 0;
+        for (const char *it = data; it < end; ++line)
+        {
+            const char *newLine = static_cast<const char *>(memchr(it, '\n', end - it));
+            const char *lineEnd = (newLine == nullptr) ? end : newLine;
+            lineViews[line] = azgra::string::SmartStringView<char>(it, lineEnd - it);
+            it = (newLine == nullptr) ? end : (newLine + 1);
+        }
+        return lineViews;
+    }
+
+    void SgmlFile::parse(DocId &docId, const bool memoryMapped)
+    {
+        if (memoryMapped)
+        {
+            m_mappedFile = MemoryMappedFile(m_fileName);
+            const std::string_view header = "<!DOCTYPE lewis SYSTEM \"lewis.dtd\">";
+            always_assert(m_mappedFile.size() >= header.length() &&
+                          std::string_view(m_mappedFile.data(), header.length()) == header && "Wrong Sgml file header.");
+            load_mapped_articles(docId);
+        }
+        else
+        {
+            m_lines = azgra::io::read_lines(m_fileName);
+            m_lineViews.resize(m_lines.size());
+            for (size_t i = 0; i < m_lines.size(); ++i)
+            {
+                m_lineViews[i] = azgra::string::SmartStringView<char>(m_lines[i]);
+            }
+
+            always_assert(m_lines[0] == "<!DOCTYPE lewis SYSTEM \"lewis.dtd\">" && "Wrong Sgml file header.");
+            load_articles(docId);
+        }
         azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Loaded %lu Reuter articles from %s.\n", m_articles.size(),
                                m_fileName);
     }
 
+    void SgmlFile::load_mapped_articles(DocId &docId)
+    {
+        // Article and TEXT boundaries are found directly in the mapped bytes, only the article lines are split into views.
+        const char *data = m_mappedFile.data();
+        const auto articleRanges = scan_sgml_articles(data, m_mappedFile.size());
+        m_articles.reserve(articleRanges.size());
+        for (const auto &range : articleRanges)
+        {
+            auto articleLines = create_line_views(data + range.begin, range.end - range.begin);
+            auto textLines = create_line_views(data + range.textBegin, range.textEnd - range.textBegin);
+            m_articles.emplace_back(docId++, articleLines, textLines);
+        }
+    }
+
     void SgmlFile::load_articles(DocId &docId)
     {
         int fromLine = -1;
@@ -58,27 +107,39 @@ namespace dis
         return ReutersArticle(id, articleLines);
     }
 
-    void SgmlFile::preprocess_article_text(const std::vector<azgra::string::SmartStringView<char>> &stopwords)
+    void SgmlFile::preprocess_article_text(const StopwordSet &stopwords, TermDictionary &dictionary,
+                                           const ArticleFilterOptions &options, const bool parallel)
     {
-        for (auto &article : m_articles)
+        // Articles are independent, tokenizer buffers and term counters are thread local, the stem cache and the dictionary
+        // are thread-safe.
+        // Article lengths differ a lot, so they are handed out dynamically in small chunks.
+        const auto articleCount = static_cast<long>(m_articles.size());
+#pragma omp parallel for schedule(dynamic, 8) if(parallel)
+        for (long i = 0; i < articleCount; ++i)
         {
-            article.filter_article_text(stopwords);
+            m_articles[i].filter_article_text(stopwords, dictionary, options);
         }
     }
 
     void SgmlFile::save_preprocessed_text(const char *fileName, const char *stopwordFile)
     {
-        const auto stopwords = azgra::io::read_lines(stopwordFile);
-        const auto stopwordViews = strings_to_views(stopwords);
+        const auto stopwords = StopwordSet::load(stopwordFile);
         std::ofstream ofStream(fileName, std::ios::out);
         always_assert(ofStream.is_open());
 
-        std::stringstream processedTextStream;
-        for (const auto &article : m_articles)
+        std::vector<std::string> articleTexts(m_articles.size());
+        const auto articleCount = static_cast<long>(m_articles.size());
+#pragma omp parallel for schedule(dynamic, 8)
+        for (long i = 0; i < articleCount; ++i)
         {
-            article.extract_filtered_article_text(processedTextStream, stopwordViews);
+            std::stringstream articleStream;
+            m_articles[i].extract_filtered_article_text(articleStream, stopwords);
+            articleTexts[i] = articleStream.str();
+        }
+        for (const auto &articleText : articleTexts)
+        {
+            ofStream << articleText;
         }
-        ofStream << processedTextStream.str();
         //ofStream.write(filteredText.c_str(), filteredText.length());
         azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green,
                                "Saved preprocessed text to %s.\nUsed stopwords from: %s\n",
@@ -91,16 +152,35 @@ namespace dis
         return m_articles;
     }
 
+    size_t SgmlFile::get_article_count() const
+    {
+        return m_articles.size();
+    }
+
+    ReutersArticle &SgmlFile::get_article(const size_t index)
+    {
+        return m_articles[index];
+    }
+
     void SgmlFile::destroy_original_text()
     {
         m_lines.clear();
         m_lineViews.clear();
+        m_mappedFile.unmap();
         for (auto &article : m_articles)
         {
             article.destroy_views();
         }
     }
 
+    void SgmlFile::assign_document_ids(DocId &docId)
+    {
+        for (auto &article : m_articles)
+        {
+            article.set_docId(docId++);
+        }
+    }
+
     void SgmlFile::index_atricles(TermIndex &index) const
     {
         for (const auto &article : m_articles)
@@ -109,4 +189,12 @@ namespace dis
         }
     }
 
+    void SgmlFile::collect_metadata(ArticleMetadataStore &store)
+    {
+        for (auto &article : m_articles)
+        {
+            store.add_article(article.get_docId(), article.release_metadata());
+        }
+    }
+
 }
\ No newline at end of file
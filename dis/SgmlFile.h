@@ -2,6 +2,8 @@
 
 #include <azgra/io/text_file_functions.h>
 #include "ReutersArticle.h"
+#include "memory_mapped_file.h"
+#include "sgml_tag_scanner.h"
 
 namespace dis
 {
@@ -19,6 +21,7 @@ namespace dis
     {
     private:
         std::vector<std::string> m_lines;
+        MemoryMappedFile m_mappedFile;
         std::vector<azgra::string::SmartStringView<char>> m_lineViews;
         std::vector<ReutersArticle> m_articles;
 
@@ -27,24 +30,41 @@ namespace dis
 
         const char *m_fileName{};
 
-        void parse(DocId &docId);
+        void parse(DocId &docId, const bool memoryMapped);
+
+        void load_mapped_articles(DocId &docId);
 
         void load_articles(DocId &docId);
 
     public:
         SgmlFile() = default;
 
-        static SgmlFile load(const char *fileName, DocId &docId);
+        static SgmlFile load(const char *fileName, DocId &docId, const bool memoryMapped = false);
 
-        void preprocess_article_text(const std::vector<azgra::string::SmartStringView<char>> &stopwords);
+        /// Filter text of all articles and count their terms.
+        /// \param stopwords Stopwords removed from the text.
+        /// \param dictionary Dictionary assigning TermIds of the terms.
+        /// \param options Article filter options.
+        /// \param parallel Process the articles concurrently, the result is the same as with serial processing.
+        void preprocess_article_text(const StopwordSet &stopwords, TermDictionary &dictionary,
+                                     const ArticleFilterOptions &options = {}, const bool parallel = true);
 
         void save_preprocessed_text(const char *fileName, const char *stopwordFile);
 
         std::vector<ReutersArticle> get_articles();
 
+        [[nodiscard]] size_t get_article_count() const;
+
+        ReutersArticle &get_article(const size_t index);
+
         void destroy_original_text();
 
+        void assign_document_ids(DocId &docId);
+
         void index_atricles(TermIndex &index) const;
+
+        /// Move metadata of all articles into the store.
+        void collect_metadata(ArticleMetadataStore &store);
     };
 }
 
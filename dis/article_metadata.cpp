@@ -0,0 +1,341 @@
+#include "article_metadata.h"
+#include <cctype>
+
+namespace dis
+{
+    static constexpr azgra::u32 MaxDate = 99999999;
+
+    static bool parse_number(std::string_view text, azgra::u32 &value)
+    {
+        if (text.empty())
+            return false;
+        value = 0;
+        for (const char c : text)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            value = (value * 10) + static_cast<azgra::u32>(c - '0');
+        }
+        return true;
+    }
+
+    azgra::u32 parse_reuters_date(std::string_view text)
+    {
+        static const char *months[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+
+        while (!text.empty() && text.front() == ' ')
+            text.remove_prefix(1);
+
+        const size_t firstDash = text.find('-');
+        const size_t secondDash = (firstDash == std::string_view::npos) ? firstDash : text.find('-', firstDash + 1);
+        if (secondDash == std::string_view::npos || (secondDash - firstDash) != 4 || text.length() < (secondDash + 5))
+            return 0;
+
+        azgra::u32 day, year;
+        if (!parse_number(text.substr(0, firstDash), day) || !parse_number(text.substr(secondDash + 1, 4), year))
+            return 0;
+
+        const std::string_view monthText = text.substr(firstDash + 1, 3);
+        for (azgra::u32 month = 0; month < 12; ++month)
+        {
+            if (monthText == months[month])
+            {
+                return (year * 10000) + ((month + 1) * 100) + day;
+            }
+        }
+        return 0;
+    }
+
+    ////////////////////////////// DocumentBitmap implementation //////////////////////////////
+
+    DocumentBitmap::DocumentBitmap(const size_t size, const bool value)
+    {
+        m_size = size;
+        m_words.resize((size + 63) / 64, value ? ~azgra::u64(0) : azgra::u64(0));
+        if (value && (size % 64) != 0)
+        {
+            m_words.back() &= (azgra::u64(1) << (size % 64)) - 1;
+        }
+    }
+
+    void DocumentBitmap::set(const DocId docId)
+    {
+        if (docId >= m_size)
+        {
+            resize(docId + 1);
+        }
+        m_words[docId / 64] |= (azgra::u64(1) << (docId % 64));
+    }
+
+    void DocumentBitmap::reset(const DocId docId)
+    {
+        if (docId < m_size)
+        {
+            m_words[docId / 64] &= ~(azgra::u64(1) << (docId % 64));
+        }
+    }
+
+    void DocumentBitmap::resize(const size_t size)
+    {
+        m_size = size;
+        m_words.resize((size + 63) / 64, 0);
+    }
+
+    size_t DocumentBitmap::count() const
+    {
+        size_t result = 0;
+        for (const azgra::u64 word : m_words)
+        {
+            result += __builtin_popcountll(word);
+        }
+        return result;
+    }
+
+    void DocumentBitmap::invert()
+    {
+        for (azgra::u64 &word : m_words)
+        {
+            word = ~word;
+        }
+        if ((m_size % 64) != 0)
+        {
+            m_words.back() &= (azgra::u64(1) << (m_size % 64)) - 1;
+        }
+    }
+
+    DocumentBitmap &DocumentBitmap::operator&=(const DocumentBitmap &other)
+    {
+        if (other.m_size > m_size)
+        {
+            resize(other.m_size);
+        }
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+            m_words[i] &= (i < other.m_words.size()) ? other.m_words[i] : 0;
+        }
+        return *this;
+    }
+
+    DocumentBitmap &DocumentBitmap::operator|=(const DocumentBitmap &other)
+    {
+        if (other.m_size > m_size)
+        {
+            resize(other.m_size);
+        }
+        for (size_t i = 0; i < other.m_words.size(); ++i)
+        {
+            m_words[i] |= other.m_words[i];
+        }
+        return *this;
+    }
+
+    ////////////////////////////// ArticleMetadataStore implementation //////////////////////////////
+
+    void ArticleMetadataStore::add_article(const DocId docId, const ArticleMetadata &metadata)
+    {
+        if (docId >= m_dates.size())
+        {
+            m_dates.resize(docId + 1, 0);
+            m_titles.resize(docId + 1);
+        }
+        m_documentCount = std::max(m_documentCount, docId);
+
+        m_dates[docId] = metadata.date;
+        m_titles[docId] = {m_titleData.length(), static_cast<azgra::u32>(metadata.title.length())};
+        m_titleData.append(metadata.title);
+
+        for (const auto &topic : metadata.topics)
+        {
+            m_topics[topic].set(docId);
+        }
+        for (const auto &place : metadata.places)
+        {
+            m_places[place].set(docId);
+        }
+    }
+
+    void ArticleMetadataStore::clear()
+    {
+        m_documentCount = 0;
+        m_dates.clear();
+        m_titles.clear();
+        m_titleData.clear();
+        m_topics.clear();
+        m_places.clear();
+    }
+
+    azgra::u32 ArticleMetadataStore::get_date(const DocId docId) const
+    {
+        return (docId < m_dates.size()) ? m_dates[docId] : 0;
+    }
+
+    std::string_view ArticleMetadataStore::get_title(const DocId docId) const
+    {
+        if (docId >= m_titles.size())
+            return {};
+        return std::string_view(m_titleData).substr(m_titles[docId].offset, m_titles[docId].length);
+    }
+
+    DocumentBitmap ArticleMetadataStore::value_bitmap(const std::map<std::string, DocumentBitmap, std::less<>> &column,
+                                                      std::string_view value) const
+    {
+        std::string lowerValue(value);
+        for (char &c : lowerValue)
+        {
+            c = static_cast<char>(tolower(c));
+        }
+
+        DocumentBitmap result(m_documentCount + 1);
+        const auto it = column.find(lowerValue);
+        if (it != column.end())
+        {
+            result |= it->second;
+        }
+        return result;
+    }
+
+    DocumentBitmap ArticleMetadataStore::date_bitmap(const azgra::u32 low, const azgra::u32 high) const
+    {
+        DocumentBitmap result(m_documentCount + 1);
+        for (DocId docId = 0; docId < m_dates.size(); ++docId)
+        {
+            const azgra::u32 date = m_dates[docId];
+            if ((date != 0) && (date >= low) && (date <= high))
+            {
+                result.set(docId);
+            }
+        }
+        return result;
+    }
+
+    bool ArticleMetadataStore::evaluate_predicate(std::string_view predicate, DocumentBitmap &result) const
+    {
+        if (predicate.substr(0, 7) == "topics:")
+        {
+            result = value_bitmap(m_topics, predicate.substr(7));
+            return true;
+        }
+        if (predicate.substr(0, 7) == "places:")
+        {
+            result = value_bitmap(m_places, predicate.substr(7));
+            return true;
+        }
+        if (predicate.substr(0, 4) == "date")
+        {
+            std::string_view op = predicate.substr(4, 2);
+            if (op != ">=" && op != "<=")
+            {
+                op = predicate.substr(4, 1);
+            }
+            std::string_view dateText = predicate.substr(4 + op.length());
+
+            // Partial dates cover the whole year or month: [low, high].
+            azgra::u32 year = 0, month = 0, day = 0;
+            bool valid = parse_number(dateText.substr(0, 4), year) && year > 0;
+            azgra::u32 low = year * 10000, high = (year * 10000) + 9999;
+            if (valid && dateText.length() > 4)
+            {
+                valid = (dateText[4] == '-') && parse_number(dateText.substr(5, 2), month);
+                low = (year * 10000) + (month * 100);
+                high = low + 99;
+            }
+            if (valid && dateText.length() > 7)
+            {
+                valid = (dateText[7] == '-') && parse_number(dateText.substr(8), day);
+                low = high = (year * 10000) + (month * 100) + day;
+            }
+
+            if (valid)
+            {
+                if (op == "=" || op == ":")
+                    result = date_bitmap(low, high);
+                else if (op == ">=")
+                    result = date_bitmap(low, MaxDate);
+                else if (op == ">")
+                    result = date_bitmap(high + 1, MaxDate);
+                else if (op == "<=")
+                    result = date_bitmap(1, high);
+                else if (op == "<")
+                    result = date_bitmap(1, low - 1);
+                else
+                    valid = false;
+            }
+            if (valid)
+                return true;
+        }
+
+        azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Invalid filter predicate `%.*s`.\n",
+                               static_cast<int>(predicate.length()), predicate.data());
+        return false;
+    }
+
+    bool ArticleMetadataStore::evaluate_filter(const char *filter, DocumentBitmap &result) const
+    {
+        std::vector<std::string_view> tokens;
+        const std::string_view filterText(filter);
+        size_t tokenStart = filterText.find_first_not_of(' ');
+        while (tokenStart != std::string_view::npos)
+        {
+            const size_t tokenEnd = filterText.find(' ', tokenStart);
+            tokens.push_back(filterText.substr(tokenStart, tokenEnd - tokenStart));
+            tokenStart = filterText.find_first_not_of(' ', tokenEnd);
+        }
+        if (tokens.empty())
+        {
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Filter string is empty.\n");
+            return false;
+        }
+
+        const size_t universe = m_documentCount + 1;
+        DocumentBitmap orResult(universe);
+        DocumentBitmap andResult(universe, true);
+        bool expectPredicate = true;
+        bool negate = false;
+        for (const auto &token : tokens)
+        {
+            if (expectPredicate)
+            {
+                if (token == "NOT")
+                {
+                    negate = !negate;
+                    continue;
+                }
+                DocumentBitmap predicateResult;
+                if (!evaluate_predicate(token, predicateResult))
+                    return false;
+                if (negate)
+                    predicateResult.invert();
+                andResult &= predicateResult;
+                negate = false;
+                expectPredicate = false;
+            }
+            else if (token == "AND")
+            {
+                expectPredicate = true;
+            }
+            else if (token == "OR")
+            {
+                orResult |= andResult;
+                andResult = DocumentBitmap(universe, true);
+                expectPredicate = true;
+            }
+            else
+            {
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Expected AND or OR in filter, got `%.*s`.\n",
+                                       static_cast<int>(token.length()), token.data());
+                return false;
+            }
+        }
+        if (expectPredicate)
+        {
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Filter ends with an operator.\n");
+            return false;
+        }
+
+        orResult |= andResult;
+        // DocId starts from 1.
+        orResult.reset(0);
+        result = std::move(orResult);
+        return true;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <azgra/azgra.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "term_index.h"
+
+namespace dis
+{
+    /// Metadata fields of the Reuters article, extracted while parsing.
+    struct ArticleMetadata
+    {
+        /// Date encoded as yyyymmdd, zero if the article has no valid date.
+        azgra::u32 date{};
+        std::string title;
+        std::vector<std::string> topics;
+        std::vector<std::string> places;
+    };
+
+    /// Parse Reuters date in format `26-FEB-1987 15:01:01.79`.
+    /// \param text Date text.
+    /// \return Date encoded as yyyymmdd or zero if the date is not valid.
+    azgra::u32 parse_reuters_date(std::string_view text);
+
+    /// Set of documents with one bit per DocId.
+    class DocumentBitmap
+    {
+    private:
+        std::vector<azgra::u64> m_words;
+        size_t m_size = 0;
+
+    public:
+        DocumentBitmap() = default;
+
+        explicit DocumentBitmap(const size_t size, const bool value = false);
+
+        void set(const DocId docId);
+
+        void reset(const DocId docId);
+
+        [[nodiscard]] bool test(const DocId docId) const
+        {
+            return (docId < m_size) && ((m_words[docId / 64] >> (docId % 64)) & 1u);
+        }
+
+        void resize(const size_t size);
+
+        [[nodiscard]] size_t size() const
+        { return m_size; }
+
+        [[nodiscard]] size_t count() const;
+
+        void invert();
+
+        DocumentBitmap &operator&=(const DocumentBitmap &other);
+
+        DocumentBitmap &operator|=(const DocumentBitmap &other);
+    };
+
+    /// Columnar store of article metadata indexed by DocId. Topics and places have a bitmap for every value.
+    class ArticleMetadataStore
+    {
+    private:
+        struct TitleRange
+        {
+            size_t offset{};
+            azgra::u32 length{};
+        };
+
+        size_t m_documentCount = 0;
+        std::vector<azgra::u32> m_dates;
+        std::vector<TitleRange> m_titles;
+        std::string m_titleData;
+        std::map<std::string, DocumentBitmap, std::less<>> m_topics;
+        std::map<std::string, DocumentBitmap, std::less<>> m_places;
+
+        [[nodiscard]] DocumentBitmap value_bitmap(const std::map<std::string, DocumentBitmap, std::less<>> &column,
+                                                  std::string_view value) const;
+
+        [[nodiscard]] DocumentBitmap date_bitmap(const azgra::u32 low, const azgra::u32 high) const;
+
+        bool evaluate_predicate(std::string_view predicate, DocumentBitmap &result) const;
+
+    public:
+        ArticleMetadataStore() = default;
+
+        void add_article(const DocId docId, const ArticleMetadata &metadata);
+
+        void clear();
+
+        [[nodiscard]] azgra::u32 get_date(const DocId docId) const;
+
+        [[nodiscard]] std::string_view get_title(const DocId docId) const;
+
+        /// Evaluate filter such as `topics:grain AND date>=1987-03`. Predicates are `topics:value`, `places:value` and date
+        /// comparisons `date=`, `date<`, `date<=`, `date>`, `date>=` with `yyyy`, `yyyy-mm` or `yyyy-mm-dd` dates. Predicates can
+        /// be combined with NOT, AND and OR, AND binds stronger than OR.
+        /// \param filter Filter text.
+        /// \param result Bitmap of the documents matching the filter.
+        /// \return False if the filter is malformed.
+        bool evaluate_filter(const char *filter, DocumentBitmap &result) const;
+    };
+}
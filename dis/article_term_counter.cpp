@@ -0,0 +1,116 @@
+#include "article_term_counter.h"
+#include <algorithm>
+#include <cstring>
+#include "hash.h"
+
+namespace dis
+{
+    static constexpr size_t InitialSlotCount = 256;
+
+    ArticleTermCounter::ArticleTermCounter()
+    {
+        m_slots.resize(InitialSlotCount);
+    }
+
+    size_t ArticleTermCounter::find_slot(const char *term, const size_t length) const
+    {
+        const size_t mask = m_slots.size() - 1;
+        size_t slot = fnv1a_hash(term, length) & mask;
+        while (m_slots[slot].used)
+        {
+            const Slot &s = m_slots[slot];
+            if ((s.length == length) && (memcmp(m_termData.data() + s.offset, term, length) == 0))
+                break;
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void ArticleTermCounter::grow()
+    {
+        std::vector<Slot> oldSlots(m_slots.size() * 2);
+        oldSlots.swap(m_slots);
+
+        // Positions refer to the slots, they are remapped to the new slot indices.
+        std::vector<azgra::u32> slotMap(oldSlots.size());
+        for (azgra::u32 &usedSlot : m_usedSlots)
+        {
+            const Slot &oldSlot = oldSlots[usedSlot];
+            const size_t newSlot = find_slot(m_termData.data() + oldSlot.offset, oldSlot.length);
+            m_slots[newSlot] = oldSlot;
+            slotMap[usedSlot] = static_cast<azgra::u32>(newSlot);
+            usedSlot = static_cast<azgra::u32>(newSlot);
+        }
+        for (auto &position : m_positions)
+        {
+            position.first = slotMap[position.first];
+        }
+    }
+
+    void ArticleTermCounter::add(const char *term, const size_t length, const azgra::u32 position, const bool recordPosition)
+    {
+        // Load factor is kept under one half so the probe sequences stay short.
+        if (((m_usedSlots.size() + 1) * 2) > m_slots.size())
+        {
+            grow();
+        }
+
+        const size_t slot = find_slot(term, length);
+        Slot &s = m_slots[slot];
+        if (!s.used)
+        {
+            s = {static_cast<azgra::u32>(m_termData.length()), static_cast<azgra::u32>(length), 0, true};
+            m_termData.append(term, length);
+            m_usedSlots.push_back(static_cast<azgra::u32>(slot));
+        }
+        ++s.count;
+        if (recordPosition)
+        {
+            m_positions.emplace_back(static_cast<azgra::u32>(slot), position);
+        }
+    }
+
+    void ArticleTermCounter::emit(TermDictionary &dictionary, std::vector<TermFrequency> &termFrequencies,
+                                  std::vector<azgra::u32> &termPositions) const
+    {
+        std::vector<std::pair<TermId, azgra::u32>> termSlots(m_usedSlots.size());
+        for (size_t i = 0; i < m_usedSlots.size(); ++i)
+        {
+            const Slot &s = m_slots[m_usedSlots[i]];
+            termSlots[i] = std::make_pair(dictionary.intern(m_termData.data() + s.offset, s.length), m_usedSlots[i]);
+        }
+        std::sort(termSlots.begin(), termSlots.end());
+
+        termFrequencies.resize(termSlots.size());
+        std::vector<azgra::u32> positionOffsets(m_positions.empty() ? 0 : m_slots.size());
+        azgra::u32 positionOffset = 0;
+        for (size_t i = 0; i < termSlots.size(); ++i)
+        {
+            const Slot &s = m_slots[termSlots[i].second];
+            termFrequencies[i] = {termSlots[i].first, s.count};
+            if (!positionOffsets.empty())
+            {
+                positionOffsets[termSlots[i].second] = positionOffset;
+                positionOffset += s.count;
+            }
+        }
+
+        // Positions are visited in ascending order, so every term gets its positions sorted.
+        termPositions.resize(m_positions.size());
+        for (const auto &[slot, position] : m_positions)
+        {
+            termPositions[positionOffsets[slot]++] = position;
+        }
+    }
+
+    void ArticleTermCounter::clear()
+    {
+        for (const azgra::u32 usedSlot : m_usedSlots)
+        {
+            m_slots[usedSlot].used = false;
+        }
+        m_usedSlots.clear();
+        m_termData.clear();
+        m_positions.clear();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <azgra/azgra.h>
+#include "term_dictionary.h"
+
+namespace dis
+{
+    /// Frequency of a term in one article.
+    struct TermFrequency
+    {
+        TermId termId{};
+        azgra::u32 frequency{};
+    };
+
+    /// Small open addressing table counting the terms of one article by their bytes. Every distinct term is looked up in the
+    /// shared dictionary only once per article. The table is meant to be reused, clear keeps the allocated memory.
+    class ArticleTermCounter
+    {
+    private:
+        struct Slot
+        {
+            azgra::u32 offset{};
+            azgra::u32 length{};
+            azgra::u32 count{};
+            bool used{};
+        };
+
+        std::string m_termData;
+        std::vector<Slot> m_slots;
+        std::vector<azgra::u32> m_usedSlots;
+        /// Pairs of slot and position in the order of occurence.
+        std::vector<std::pair<azgra::u32, azgra::u32>> m_positions;
+
+        [[nodiscard]] size_t find_slot(const char *term, const size_t length) const;
+
+        void grow();
+
+    public:
+        ArticleTermCounter();
+
+        /// Count the term occurence.
+        /// \param term Term bytes.
+        /// \param length Term length.
+        /// \param position Position of the word in the article.
+        /// \param recordPosition Store the position too.
+        void add(const char *term, const size_t length, const azgra::u32 position, const bool recordPosition);
+
+        /// Intern the counted terms and write their frequencies ordered by TermId.
+        /// \param dictionary Dictionary assigning the TermIds.
+        /// \param termFrequencies Output term frequencies.
+        /// \param termPositions Output positions, concatenated in the order of termFrequencies, if they were recorded.
+        void emit(TermDictionary &dictionary, std::vector<TermFrequency> &termFrequencies, std::vector<azgra::u32> &termPositions) const;
+
+        void clear();
+    };
+}
@@ -0,0 +1,405 @@
+#include "benchmark.h"
+#include <cstring>
+#include <azgra/string/smart_string_view.h>
+#include "../Stopwatch.h"
+#include "memory_mapped_file.h"
+#include "sgml_tag_scanner.h"
+#include "SgmlFile.h"
+#include "inplace_stemmer.h"
+#include "binary_index.h"
+#include "postings_codec.h"
+#include "fibonacci_coding.h"
+
+namespace dis
+{
+    typedef azgra::string::SmartStringView<char> AsciiTextView;
+
+    static void print_throughput(const char *method, const size_t bytes, const size_t repetitions, const double milliseconds)
+    {
+        const double megabytes = (static_cast<double>(bytes) * static_cast<double>(repetitions)) / (1024.0 * 1024.0);
+        fprintf(stdout, "%-12s %10.2f MB/s (%.3f ms per pass)\n", method, megabytes / (milliseconds / 1000.0),
+                milliseconds / static_cast<double>(repetitions));
+    }
+
+    /// Line based article search as done by SgmlFile::load_articles and ReutersArticle::parse_article.
+    static std::pair<size_t, size_t> line_based_scan(const char *data, const size_t size)
+    {
+        std::vector<AsciiTextView> lines;
+        const char *end = data + size;
+        for (const char *it = data; it < end;)
+        {
+            const char *newLine = static_cast<const char *>(memchr(it, '\n', end - it));
+            const char *lineEnd = (newLine == nullptr) ? end : newLine;
+            lines.emplace_back(it, lineEnd - it);
+            it = (newLine == nullptr) ? end : (newLine + 1);
+        }
+
+        size_t articleCount = 0;
+        size_t textLineCount = 0;
+        bool insideText = false;
+        for (const auto &line : lines)
+        {
+            if (line.starts_with("<REUTERS "))
+                continue;
+            if (line.starts_with("</REUTERS>"))
+            {
+                ++articleCount;
+                continue;
+            }
+            if (line.starts_with("<TEXT"))
+            {
+                insideText = true;
+                continue;
+            }
+            if (line.contains("</TEXT>"))
+            {
+                insideText = false;
+                continue;
+            }
+            if (insideText)
+                ++textLineCount;
+        }
+        return std::make_pair(articleCount, textLineCount);
+    }
+
+    void benchmark_sgml_tag_scanner(const char *sgmlFile, const size_t repetitions)
+    {
+        const MemoryMappedFile file(sgmlFile);
+        azgra::Stopwatch stopwatch;
+        fprintf(stdout, "SGML tag scanner benchmark, %s (%lu bytes), %lu passes\n", sgmlFile, file.size(), repetitions);
+
+        size_t articleCount = 0;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            articleCount = line_based_scan(file.data(), file.size()).first;
+        }
+        stopwatch.stop();
+        print_throughput("line-based", file.size(), repetitions, stopwatch.elapsed_milliseconds());
+
+        const std::pair<const char *, SgmlScannerKernel> kernels[] = {{"scalar", SgmlScannerKernel::Scalar},
+                                                                      {"sse2",   SgmlScannerKernel::SSE2},
+                                                                      {"avx2",   SgmlScannerKernel::AVX2}};
+        for (const auto &[name, kernel] : kernels)
+        {
+            if (!is_scanner_kernel_supported(kernel))
+            {
+                fprintf(stdout, "%-12s not supported\n", name);
+                continue;
+            }
+            size_t scannedArticleCount = 0;
+            stopwatch.start();
+            for (size_t i = 0; i < repetitions; ++i)
+            {
+                scannedArticleCount = scan_sgml_articles(file.data(), file.size(), kernel).size();
+            }
+            stopwatch.stop();
+            print_throughput(name, file.size(), repetitions, stopwatch.elapsed_milliseconds());
+            always_assert(scannedArticleCount == articleCount && "Scanner found different number of articles.");
+        }
+    }
+
+    /// Original line filter of ReutersArticle, kept as the baseline of the tokenizer benchmark.
+    static size_t legacy_filter_line(std::stringstream &ss, const AsciiTextView &line, const std::vector<AsciiTextView> &stopwords)
+    {
+        std::stringstream lineStream;
+        for (const auto &c : line)
+        {
+            if ((c >= 'a' && c <= 'z') || (c == ' ') || (c >= '0' && c <= '9'))
+                lineStream << c;
+            else if (c >= 'A' && c <= 'Z')
+                lineStream << static_cast<char>(c + ('a' - 'A'));
+            else if (c == '<' || c == '>' || c == '/' || c == '\\' || c == '.' || c == '-')
+                lineStream << ' ';
+        }
+        size_t tokenCount = 0;
+        const auto lineString = lineStream.str();
+        const auto words = azgra::string::SmartStringView<char>(lineString.c_str()).split(' ');
+        for (const auto word : words)
+        {
+            if (word.is_empty())
+                continue;
+            ++tokenCount;
+            if (!azgra::collection::contains(stopwords.begin(), stopwords.end(), word))
+            {
+                AsciiString str = stem_word(word.data(), word.length());
+                ss << str.get_c_string() << ' ';
+            }
+        }
+        return tokenCount;
+    }
+
+    static void print_token_throughput(const char *method, const size_t tokenCount, const double milliseconds)
+    {
+        fprintf(stdout, "%-28s %12.0f tokens/s (%.3f ms)\n", method,
+                static_cast<double>(tokenCount) / (milliseconds / 1000.0), milliseconds);
+    }
+
+    void benchmark_tokenizer(const char *sgmlFile, const char *stopwordFile, const size_t repetitions)
+    {
+        const auto stopwordLines = azgra::io::read_lines(stopwordFile);
+        const auto stopwords = strings_to_views(stopwordLines);
+        const StopwordSet stopwordSet(stopwordLines);
+        DocId docId = 1;
+        SgmlFile file = SgmlFile::load(sgmlFile, docId, true);
+        azgra::Stopwatch stopwatch;
+
+        size_t legacyTokenCount = 0;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            for (size_t articleIndex = 0; articleIndex < file.get_article_count(); ++articleIndex)
+            {
+                std::stringstream articleStream;
+                for (const auto &line : file.get_article(articleIndex).get_text_lines())
+                {
+                    legacyTokenCount += legacy_filter_line(articleStream, line, stopwords);
+                    articleStream << '\n';
+                }
+            }
+        }
+        stopwatch.stop();
+        print_token_throughput("stringstream filter_line", legacyTokenCount, stopwatch.elapsed_milliseconds());
+
+        size_t tokenCount = 0;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            for (size_t articleIndex = 0; articleIndex < file.get_article_count(); ++articleIndex)
+            {
+                for (const auto &line : file.get_article(articleIndex).get_text_lines())
+                {
+                    tokenize_line(line.data(), line.length(), [&tokenCount](const char *, const size_t)
+                    { ++tokenCount; });
+                }
+            }
+        }
+        stopwatch.stop();
+        print_token_throughput("table tokenizer only", tokenCount, stopwatch.elapsed_milliseconds());
+        always_assert(tokenCount == legacyTokenCount && "Tokenizers produced different number of tokens.");
+
+        TermDictionary dictionary;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            for (size_t articleIndex = 0; articleIndex < file.get_article_count(); ++articleIndex)
+            {
+                file.get_article(articleIndex).filter_article_text(stopwordSet, dictionary);
+            }
+        }
+        stopwatch.stop();
+        print_token_throughput("filter_article_text", legacyTokenCount, stopwatch.elapsed_milliseconds());
+    }
+
+    static void print_word_throughput(const char *method, const size_t wordCount, const double milliseconds)
+    {
+        fprintf(stdout, "%-28s %12.0f words/s (%.3f ms)\n", method,
+                static_cast<double>(wordCount) / (milliseconds / 1000.0), milliseconds);
+    }
+
+    void benchmark_stemmer(const char *sgmlFile, const size_t repetitions)
+    {
+        DocId docId = 1;
+        SgmlFile file = SgmlFile::load(sgmlFile, docId, true);
+        std::string words;
+        std::vector<std::pair<size_t, size_t>> wordRanges;
+        for (size_t articleIndex = 0; articleIndex < file.get_article_count(); ++articleIndex)
+        {
+            for (const auto &line : file.get_article(articleIndex).get_text_lines())
+            {
+                tokenize_line(line.data(), line.length(), [&words, &wordRanges](const char *token, const size_t tokenLength)
+                {
+                    wordRanges.emplace_back(words.length(), tokenLength);
+                    words.append(token, tokenLength);
+                });
+            }
+        }
+        fprintf(stdout, "Stemmer benchmark, %lu words, %lu passes\n", wordRanges.size(), repetitions);
+        azgra::Stopwatch stopwatch;
+
+        size_t stemLengthSum = 0;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            for (const auto &[offset, length] : wordRanges)
+            {
+                stemLengthSum += stem_word(words.data() + offset, length).length();
+            }
+        }
+        stopwatch.stop();
+        print_word_throughput("stem_word", wordRanges.size() * repetitions, stopwatch.elapsed_milliseconds());
+
+        // Every pass stems a fresh copy, the copy isn't part of the measured time.
+        std::string batchWords;
+        std::vector<StemSpan> spans(wordRanges.size());
+        size_t batchStemLengthSum = 0;
+        double batchMilliseconds = 0.0;
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            batchWords = words;
+            for (size_t w = 0; w < wordRanges.size(); ++w)
+            {
+                spans[w] = {batchWords.data() + wordRanges[w].first, wordRanges[w].second};
+            }
+            stopwatch.start();
+            stem_batch(spans.data(), spans.size());
+            stopwatch.stop();
+            batchMilliseconds += stopwatch.elapsed_milliseconds();
+            for (const StemSpan &span : spans)
+            {
+                batchStemLengthSum += span.length;
+            }
+        }
+        print_word_throughput("stem_batch", wordRanges.size() * repetitions, batchMilliseconds);
+        always_assert(stemLengthSum == batchStemLengthSum && "Stemmers produced different stems.");
+    }
+
+    void benchmark_postings_codecs(const char *indexFile, const size_t repetitions)
+    {
+        const MappedTermIndex index(indexFile);
+        std::vector<azgra::u32> deltas;
+        std::vector<size_t> listEnds;
+        for (size_t rank = 0; rank < index.size(); ++rank)
+        {
+            const PostingList postings = index.get_postings(rank);
+            for (size_t i = 0; i < postings.size; ++i)
+            {
+                deltas.push_back((i == 0) ? postings.docIds[i] : (postings.docIds[i] - postings.docIds[i - 1]));
+            }
+            listEnds.push_back(deltas.size());
+        }
+        fprintf(stdout, "Postings codec benchmark, %lu lists, %lu document ids, %lu passes\n", listEnds.size(), deltas.size(),
+                repetitions);
+
+        azgra::Stopwatch stopwatch;
+        std::vector<azgra::u32> decoded(deltas.size());
+        for (const PostingsCodecType type : {PostingsCodecType::Fibonacci, PostingsCodecType::VByte, PostingsCodecType::StreamVByte,
+                                             PostingsCodecType::PFor})
+        {
+            const auto codec = create_postings_codec(type);
+            std::vector<azgra::byte> buffer;
+            stopwatch.start();
+            size_t listBegin = 0;
+            for (const size_t listEnd : listEnds)
+            {
+                codec->encode(deltas.data() + listBegin, listEnd - listBegin, buffer);
+                listBegin = listEnd;
+            }
+            stopwatch.stop();
+            const double encodeMilliseconds = stopwatch.elapsed_milliseconds();
+            const size_t encodedSize = buffer.size();
+            buffer.resize(buffer.size() + PostingsCodec::DecodePadding, 0);
+
+            stopwatch.start();
+            for (size_t i = 0; i < repetitions; ++i)
+            {
+                const azgra::byte *data = buffer.data();
+                listBegin = 0;
+                for (const size_t listEnd : listEnds)
+                {
+                    data = codec->decode(data, listEnd - listBegin, decoded.data() + listBegin);
+                    listBegin = listEnd;
+                }
+            }
+            stopwatch.stop();
+            always_assert(decoded == deltas && "Codec decoded different values.");
+
+            const double decodeSeconds = stopwatch.elapsed_milliseconds() / 1000.0;
+            fprintf(stdout, "%-14s %6.2f bits/int  ratio %5.2f  encode %12.0f ints/s  decode %12.0f ints/s\n", codec->get_name(),
+                    (8.0 * static_cast<double>(encodedSize)) / static_cast<double>(deltas.size()),
+                    static_cast<double>(deltas.size() * sizeof(azgra::u32)) / static_cast<double>(encodedSize),
+                    static_cast<double>(deltas.size()) / (encodeMilliseconds / 1000.0),
+                    static_cast<double>(deltas.size() * repetitions) / decodeSeconds);
+        }
+    }
+
+    static void print_int_throughput(const char *method, const size_t intCount, const double milliseconds)
+    {
+        fprintf(stdout, "%-28s %12.0f ints/s (%.3f ms)\n", method, static_cast<double>(intCount) / (milliseconds / 1000.0),
+                milliseconds);
+    }
+
+    void benchmark_fibonacci_coding(const char *indexFile, const size_t repetitions)
+    {
+        const BitStreamLayout *layout = get_bit_stream_layout();
+        if (layout == nullptr)
+        {
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Bit stream layout is unknown, nothing to compare.\n");
+            return;
+        }
+        const MappedTermIndex index(indexFile);
+        std::vector<std::pair<std::string, std::vector<DocId>>> deltaLists;
+        size_t intCount = 0;
+        for (size_t rank = 0; rank < index.size(); ++rank)
+        {
+            const PostingList postings = index.get_postings(rank);
+            std::vector<DocId> deltas(postings.size);
+            for (size_t i = 0; i < postings.size; ++i)
+            {
+                deltas[i] = (i == 0) ? postings.docIds[i] : (postings.docIds[i] - postings.docIds[i - 1]);
+            }
+            intCount += postings.size;
+            deltaLists.emplace_back(std::string(index.get_term(rank)), std::move(deltas));
+        }
+        fprintf(stdout, "Fibonacci coding benchmark, %lu lists, %lu document ids, %lu passes\n", deltaLists.size(), intCount,
+                repetitions);
+        azgra::Stopwatch stopwatch;
+
+        auto fibSeq = generate_fibonacci_sequence(50);
+        std::vector<azgra::byte> legacyBuffer;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            azgra::io::stream::OutMemoryBitStream bitStream;
+            for (const auto &[term, deltas] : deltaLists)
+            {
+                encode_delta_with_fibonacci_sequence(bitStream, term, deltas, fibSeq);
+            }
+            bitStream.write_value<azgra::u32>(0);
+            legacyBuffer = bitStream.get_flushed_buffer();
+        }
+        stopwatch.stop();
+        print_int_throughput("bit serial encode", intCount * repetitions, stopwatch.elapsed_milliseconds());
+
+        std::vector<azgra::byte> tableBuffer;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            FibonacciIndexWriter writer(*layout);
+            for (size_t rank = 0; rank < index.size(); ++rank)
+            {
+                const PostingList postings = index.get_postings(rank);
+                writer.add_term(index.get_term(rank), postings.docIds, postings.size);
+            }
+            tableBuffer = writer.finish();
+        }
+        stopwatch.stop();
+        print_int_throughput("table encode", intCount * repetitions, stopwatch.elapsed_milliseconds());
+        always_assert(tableBuffer == legacyBuffer && "Table driven encoder wrote different bytes.");
+
+        size_t legacyDecoded = 0;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            azgra::io::stream::InMemoryBitStream bitStream(&legacyBuffer);
+            legacyDecoded = decode_deltas_from_fibonacci_sequence(bitStream, fibSeq).size();
+        }
+        stopwatch.stop();
+        print_int_throughput("bit serial decode", intCount * repetitions, stopwatch.elapsed_milliseconds());
+
+        size_t tableDecoded = 0;
+        stopwatch.start();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            FibonacciIndexReader reader(tableBuffer, *layout);
+            tableDecoded = 0;
+            while (reader.read_next())
+            {
+                ++tableDecoded;
+            }
+        }
+        stopwatch.stop();
+        print_int_throughput("table decode", intCount * repetitions, stopwatch.elapsed_milliseconds());
+        always_assert(tableDecoded == legacyDecoded && "Decoders read different number of terms.");
+    }
+}
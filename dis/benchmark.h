@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dis
+{
+    /// Compare throughput of the vectorized SGML tag scanner with the line based article parsing.
+    /// \param sgmlFile Reuters SGML file.
+    /// \param repetitions Number of passes over the file for each method.
+    void benchmark_sgml_tag_scanner(const char *sgmlFile, const size_t repetitions = 20);
+
+    /// Compare tokens/sec of the table driven tokenizer with the original stringstream based line filter.
+    /// \param sgmlFile Reuters SGML file.
+    /// \param stopwordFile File with stopwords.
+    /// \param repetitions Number of passes over the articles for each method.
+    void benchmark_tokenizer(const char *sgmlFile, const char *stopwordFile, const size_t repetitions = 5);
+
+    /// Compare words/sec of the in place batch stemmer with stem_word on the article words.
+    /// \param sgmlFile Reuters SGML file.
+    /// \param repetitions Number of passes over the words for each stemmer.
+    void benchmark_stemmer(const char *sgmlFile, const size_t repetitions = 5);
+
+    /// Compare compression ratio and decode ints/sec of the postings codecs on the document id deltas.
+    /// \param indexFile Binary index written by SgmlFileCollection::dump_index.
+    /// \param repetitions Number of decode passes over all posting lists for each codec.
+    void benchmark_postings_codecs(const char *indexFile, const size_t repetitions = 10);
+
+    /// Compare ints/sec of the table driven Fibonacci coding with the original bit serial one, both write the same bytes.
+    /// \param indexFile Binary index written by SgmlFileCollection::dump_index.
+    /// \param repetitions Number of passes for each method.
+    void benchmark_fibonacci_coding(const char *indexFile, const size_t repetitions = 3);
+}
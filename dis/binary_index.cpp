@@ -0,0 +1,147 @@
+#include "binary_index.h"
+#include "binary_io.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+
+namespace dis
+{
+    bool is_binary_index(const char *path)
+    {
+        return file_starts_with_magic(path, BinaryIndexMagic);
+    }
+
+    BinaryIndexWriter::BinaryIndexWriter(const char *path) :
+            m_stream(path, std::ios::out | std::ios::binary), m_frequencyPath(std::string(path) + ".frequencies"),
+            m_frequencyStream(m_frequencyPath, std::ios::out | std::ios::binary)
+    {
+        always_assert(m_stream.is_open() && m_frequencyStream.is_open() && "Failed to create binary index.");
+        memcpy(m_header.magic, BinaryIndexMagic, sizeof(BinaryIndexMagic));
+        m_header.version = BinaryIndexVersion;
+        m_header.postingsOffset = sizeof(BinaryIndexHeader);
+        // Header is rewritten by finish.
+        m_stream.write(reinterpret_cast<const char *>(&m_header), sizeof(BinaryIndexHeader));
+        m_postingOffsets.push_back(0);
+        m_termOffsets.push_back(0);
+    }
+
+    BinaryIndexWriter::~BinaryIndexWriter()
+    {
+        m_frequencyStream.close();
+        std::remove(m_frequencyPath.c_str());
+    }
+
+    void BinaryIndexWriter::begin_term(const std::string_view &term)
+    {
+        always_assert(!m_finished && !m_termOpen);
+        always_assert((m_header.termCount == 0 ||
+                       std::string_view(m_termData).substr(m_termOffsets[m_termOffsets.size() - 2]) < term) &&
+                      "Terms must be added in ascending order.");
+        m_termData.append(term);
+        m_termOffsets.push_back(m_termData.length());
+        m_termOpen = true;
+    }
+
+    void BinaryIndexWriter::append_postings(const azgra::u32 *docIds, const azgra::u32 *frequencies, const size_t count)
+    {
+        always_assert(m_termOpen);
+        m_stream.write(reinterpret_cast<const char *>(docIds), count * sizeof(azgra::u32));
+        m_frequencyStream.write(reinterpret_cast<const char *>(frequencies), count * sizeof(azgra::u32));
+        m_header.postingCount += count;
+    }
+
+    void BinaryIndexWriter::end_term()
+    {
+        always_assert(m_termOpen);
+        m_postingOffsets.push_back(m_header.postingCount);
+        ++m_header.termCount;
+        m_termOpen = false;
+    }
+
+    void BinaryIndexWriter::add_term(const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies,
+                                     const size_t count)
+    {
+        begin_term(term);
+        append_postings(docIds, frequencies, count);
+        end_term();
+    }
+
+    void BinaryIndexWriter::finish()
+    {
+        always_assert(!m_finished && !m_termOpen);
+        m_frequencyStream.close();
+        always_assert(m_frequencyStream.good() && "Failed to write term frequencies.");
+        {
+            // Frequencies are copied in chunks, so the memory doesn't grow with the collection.
+            std::ifstream frequencies(m_frequencyPath, std::ios::in | std::ios::binary);
+            std::vector<char> chunk(1024 * 1024);
+            while (frequencies.read(chunk.data(), chunk.size()) || (frequencies.gcount() > 0))
+            {
+                m_stream.write(chunk.data(), frequencies.gcount());
+            }
+        }
+        std::remove(m_frequencyPath.c_str());
+
+        m_header.postingOffsetsOffset = m_header.postingsOffset + (2 * m_header.postingCount * sizeof(azgra::u32));
+        m_header.termOffsetsOffset = m_header.postingOffsetsOffset + (m_postingOffsets.size() * sizeof(azgra::u64));
+        m_header.termDataOffset = m_header.termOffsetsOffset + (m_termOffsets.size() * sizeof(azgra::u64));
+        m_header.fileSize = m_header.termDataOffset + m_termData.length();
+
+        m_stream.write(reinterpret_cast<const char *>(m_postingOffsets.data()), m_postingOffsets.size() * sizeof(azgra::u64));
+        m_stream.write(reinterpret_cast<const char *>(m_termOffsets.data()), m_termOffsets.size() * sizeof(azgra::u64));
+        m_stream.write(m_termData.data(), m_termData.length());
+        m_stream.seekp(0);
+        m_stream.write(reinterpret_cast<const char *>(&m_header), sizeof(BinaryIndexHeader));
+        m_stream.flush();
+        always_assert(m_stream.good() && "Failed to write binary index.");
+        m_finished = true;
+    }
+
+    MappedTermIndex::MappedTermIndex(const char *path) : m_file(path)
+    {
+        always_assert(m_file.size() >= sizeof(BinaryIndexHeader) && "File is too small to be a binary index.");
+        m_header = reinterpret_cast<const BinaryIndexHeader *>(m_file.data());
+        always_assert(memcmp(m_header->magic, BinaryIndexMagic, sizeof(BinaryIndexMagic)) == 0 && "Not a binary index.");
+        always_assert(m_header->version == BinaryIndexVersion && "Unsupported binary index version.");
+        always_assert(m_header->fileSize == m_file.size() && "Binary index is truncated.");
+
+        // Queries touch only few pages, read ahead would only waste the page cache.
+        madvise(const_cast<char *>(m_file.data()), m_file.size(), MADV_RANDOM);
+
+        m_docIds = reinterpret_cast<const azgra::u32 *>(m_file.data() + m_header->postingsOffset);
+        m_frequencies = m_docIds + m_header->postingCount;
+        m_postingOffsets = reinterpret_cast<const azgra::u64 *>(m_file.data() + m_header->postingOffsetsOffset);
+        m_termOffsets = reinterpret_cast<const azgra::u64 *>(m_file.data() + m_header->termOffsetsOffset);
+        m_termData = m_file.data() + m_header->termDataOffset;
+    }
+
+    size_t MappedTermIndex::find(const std::string_view &term) const
+    {
+        return find_term_rank(term, size(), [this](const size_t rank)
+                              { return get_term(rank); });
+    }
+
+    std::string_view MappedTermIndex::get_term(const size_t rank) const
+    {
+        return std::string_view(m_termData + m_termOffsets[rank], m_termOffsets[rank + 1] - m_termOffsets[rank]);
+    }
+
+    PostingList MappedTermIndex::get_postings(const size_t rank) const
+    {
+        const size_t offset = m_postingOffsets[rank];
+        return PostingList{m_docIds + offset, m_frequencies + offset, m_postingOffsets[rank + 1] - offset};
+    }
+
+    DocId MappedTermIndex::get_max_doc_id() const
+    {
+        azgra::u32 maxDocId = 0;
+        for (size_t rank = 0; rank < size(); ++rank)
+        {
+            const PostingList postings = get_postings(rank);
+            if (postings.size != 0)
+                maxDocId = std::max(maxDocId, postings.docIds[postings.size - 1]);
+        }
+        return maxDocId;
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <azgra/azgra.h>
+#include "frozen_term_index.h"
+#include "memory_mapped_file.h"
+
+namespace dis
+{
+    /// Header of the binary index file. The file is laid out so it can be queried directly from the memory mapping:
+    /// header, document ids, term frequencies, posting offsets, term offsets and term data. Document ids and frequencies are
+    /// parallel arrays of postingCount values. Values are stored in the native byte order.
+    struct BinaryIndexHeader
+    {
+        char magic[4];
+        azgra::u32 version;
+        azgra::u64 termCount;
+        azgra::u64 postingCount;
+        /// Byte offset of the document ids, the frequencies follow them.
+        azgra::u64 postingsOffset;
+        /// Byte offset of termCount + 1 offsets into the posting arrays, in postings.
+        azgra::u64 postingOffsetsOffset;
+        /// Byte offset of termCount + 1 offsets into the term data.
+        azgra::u64 termOffsetsOffset;
+        /// Byte offset of the sorted terms.
+        azgra::u64 termDataOffset;
+        azgra::u64 fileSize;
+    };
+    static_assert(sizeof(BinaryIndexHeader) == 64, "Binary index header must keep its size.");
+
+    constexpr char BinaryIndexMagic[4] = {'T', 'D', 'A', 'B'};
+    constexpr azgra::u32 BinaryIndexVersion = 2;
+
+    /// Check whether the file starts with the binary index magic.
+    bool is_binary_index(const char *path);
+
+    /// Writes the binary index term by term, only the term table is kept in memory. Document ids are streamed to the file,
+    /// frequencies to the side file, which is copied behind them when the index is finished.
+    class BinaryIndexWriter
+    {
+    private:
+        std::ofstream m_stream;
+        std::string m_frequencyPath;
+        std::ofstream m_frequencyStream;
+        BinaryIndexHeader m_header{};
+        std::vector<azgra::u64> m_postingOffsets;
+        std::vector<azgra::u64> m_termOffsets;
+        std::string m_termData;
+        bool m_termOpen = false;
+        bool m_finished = false;
+
+    public:
+        explicit BinaryIndexWriter(const char *path);
+
+        ~BinaryIndexWriter();
+
+        BinaryIndexWriter(const BinaryIndexWriter &) = delete;
+
+        BinaryIndexWriter &operator=(const BinaryIndexWriter &) = delete;
+
+        /// Start the term, its postings are appended until end_term. Terms must be added in ascending order.
+        void begin_term(const std::string_view &term);
+
+        /// Append postings of the current term, document ids must continue in ascending order.
+        void append_postings(const azgra::u32 *docIds, const azgra::u32 *frequencies, const size_t count);
+
+        void end_term();
+
+        /// Append the term and its postings, terms must be added in ascending order.
+        /// \param term Term.
+        /// \param docIds Ascending document ids.
+        /// \param frequencies Term frequencies of the documents.
+        /// \param count Number of postings.
+        void add_term(const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies, const size_t count);
+
+        /// Write the term table and the header.
+        void finish();
+    };
+
+    /// Binary index queried in place from its memory mapping, nothing is deserialized when it is opened. Provides the same
+    /// term lookup as FrozenTermIndex, positions and TermIds aren't stored in the file.
+    class MappedTermIndex
+    {
+    private:
+        MemoryMappedFile m_file;
+        const BinaryIndexHeader *m_header = nullptr;
+        const azgra::u32 *m_docIds = nullptr;
+        const azgra::u32 *m_frequencies = nullptr;
+        const azgra::u64 *m_postingOffsets = nullptr;
+        const azgra::u64 *m_termOffsets = nullptr;
+        const char *m_termData = nullptr;
+
+    public:
+        static constexpr size_t NotFound = FrozenTermIndex::NotFound;
+
+        explicit MappedTermIndex(const char *path);
+
+        MappedTermIndex(const MappedTermIndex &) = delete;
+
+        MappedTermIndex &operator=(const MappedTermIndex &) = delete;
+
+        /// Find rank of the term by binary search in the term table.
+        /// \return Rank of the term or NotFound.
+        [[nodiscard]] size_t find(const std::string_view &term) const;
+
+        [[nodiscard]] std::string_view get_term(const size_t rank) const;
+
+        [[nodiscard]] PostingList get_postings(const size_t rank) const;
+
+        [[nodiscard]] size_t size() const
+        { return m_header->termCount; }
+
+        [[nodiscard]] bool empty() const
+        { return (m_header->termCount == 0); }
+
+        [[nodiscard]] size_t get_posting_count() const
+        { return m_header->postingCount; }
+
+        /// Largest document id of all postings, zero if the index is empty.
+        [[nodiscard]] DocId get_max_doc_id() const;
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    /// Append the bytes of the trivially copyable value to the buffer.
+    template<typename T>
+    inline void append_value(std::vector<azgra::byte> &buffer, const T &value)
+    {
+        const size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    /// Read unaligned value at the offset and move the offset behind it.
+    template<typename T>
+    inline T read_value(const void *data, size_t &offset)
+    {
+        T value;
+        memcpy(&value, static_cast<const char *>(data) + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    /// Check whether the file starts with the magic bytes of an index format.
+    template<size_t MagicSize>
+    inline bool file_starts_with_magic(const char *path, const char (&magic)[MagicSize])
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        char fileMagic[MagicSize] = {};
+        return (stream.read(fileMagic, MagicSize) && (memcmp(fileMagic, magic, MagicSize) == 0));
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+
+namespace dis
+{
+    /// Blocking FIFO queue with limited capacity used to connect pipeline stages.
+    template<typename T>
+    class BoundedQueue
+    {
+    private:
+        std::mutex m_lock;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+        std::queue<T> m_queue;
+        size_t m_capacity;
+        bool m_closed = false;
+
+    public:
+        explicit BoundedQueue(const size_t capacity) : m_capacity(capacity)
+        {
+        }
+
+        /// Push the item, blocks while the queue is full.
+        void push(T item)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_notFull.wait(lock, [this]()
+            { return (m_queue.size() < m_capacity); });
+            m_queue.push(std::move(item));
+            lock.unlock();
+            m_notEmpty.notify_one();
+        }
+
+        /// Pop the item, blocks while the queue is empty and not closed.
+        /// \param item Popped item.
+        /// \return False if the queue is closed and there are no more items.
+        bool pop(T &item)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_notEmpty.wait(lock, [this]()
+            { return (!m_queue.empty() || m_closed); });
+            if (m_queue.empty())
+                return false;
+            item = std::move(m_queue.front());
+            m_queue.pop();
+            lock.unlock();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        /// No more items will be pushed, waiting consumers are woken up.
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_closed = true;
+            }
+            m_notEmpty.notify_all();
+        }
+    };
+}
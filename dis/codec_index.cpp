@@ -0,0 +1,102 @@
+#include "codec_index.h"
+#include "binary_io.h"
+#include <cstring>
+#include <fstream>
+
+namespace dis
+{
+    bool is_codec_index(const char *path)
+    {
+        return file_starts_with_magic(path, CodecIndexMagic);
+    }
+
+    size_t append_coded_term(const PostingsCodec &codec, const std::string_view &term, const azgra::u32 *docIds, const size_t count,
+                             std::vector<azgra::u32> &deltas, std::vector<azgra::byte> &buffer)
+    {
+        deltas.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            deltas[i] = (i == 0) ? docIds[i] : (docIds[i] - docIds[i - 1]);
+        }
+
+        append_value(buffer, static_cast<azgra::u32>(term.length()));
+        buffer.insert(buffer.end(), term.begin(), term.end());
+        append_value(buffer, static_cast<azgra::u32>(count));
+        const size_t sizeOffset = buffer.size();
+        append_value(buffer, azgra::u32(0));
+        const size_t dataOffset = buffer.size();
+        codec.encode(deltas.data(), count, buffer);
+        const auto encodedSize = static_cast<azgra::u32>(buffer.size() - dataOffset);
+        memcpy(buffer.data() + sizeOffset, &encodedSize, sizeof(encodedSize));
+        return dataOffset;
+    }
+
+    void read_coded_term(const PostingsCodec &codec, const azgra::byte *data, size_t &offset, std::string_view &term,
+                         std::vector<azgra::u32> &docIds)
+    {
+        const auto termLength = read_value<azgra::u32>(data, offset);
+        term = std::string_view(reinterpret_cast<const char *>(data + offset), termLength);
+        offset += termLength;
+        const auto postingCount = read_value<azgra::u32>(data, offset);
+        const auto encodedSize = read_value<azgra::u32>(data, offset);
+
+        docIds.resize(postingCount);
+        const azgra::byte *end = codec.decode(data + offset, postingCount, docIds.data());
+        always_assert(end == (data + offset + encodedSize) && "Corrupted compressed index.");
+        offset += encodedSize;
+        for (size_t i = 1; i < postingCount; ++i)
+        {
+            docIds[i] += docIds[i - 1];
+        }
+    }
+
+    CodecIndexWriter::CodecIndexWriter(const PostingsCodecType codec) : m_codec(create_postings_codec(codec))
+    {
+        memcpy(m_header.magic, CodecIndexMagic, sizeof(CodecIndexMagic));
+        m_header.version = CodecIndexVersion;
+        m_header.codec = codec;
+        m_buffer.resize(sizeof(CodecIndexHeader));
+    }
+
+    void CodecIndexWriter::add_term(const std::string_view &term, const azgra::u32 *docIds, const size_t count)
+    {
+        m_directory.add_term(term, append_coded_term(*m_codec, term, docIds, count, m_deltas, m_buffer), count);
+        ++m_header.termCount;
+    }
+
+    void CodecIndexWriter::write(const char *path)
+    {
+        memcpy(m_buffer.data(), &m_header, sizeof(CodecIndexHeader));
+        m_directory.append_to(m_buffer);
+        std::ofstream stream(path, std::ios::out | std::ios::binary);
+        stream.write(reinterpret_cast<const char *>(m_buffer.data()), m_buffer.size());
+        always_assert(stream.good() && "Failed to write compressed index.");
+    }
+
+    CodecIndexReader::CodecIndexReader(const char *path)
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+        always_assert(stream.is_open() && "Failed to open compressed index.");
+        const auto fileSize = static_cast<size_t>(stream.tellg());
+        always_assert(fileSize >= sizeof(CodecIndexHeader) && "File is too small to be a compressed index.");
+        // Decoders may read past the last term.
+        m_buffer.resize(fileSize + PostingsCodec::DecodePadding, 0);
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(m_buffer.data()), fileSize);
+
+        m_header = reinterpret_cast<const CodecIndexHeader *>(m_buffer.data());
+        always_assert(memcmp(m_header->magic, CodecIndexMagic, sizeof(CodecIndexMagic)) == 0 && "Not a compressed index.");
+        always_assert(m_header->version == CodecIndexVersion && "Unsupported compressed index version.");
+        m_codec = create_postings_codec(m_header->codec);
+        m_offset = sizeof(CodecIndexHeader);
+    }
+
+    bool CodecIndexReader::read_next()
+    {
+        if (m_termIndex == m_header->termCount)
+            return false;
+        ++m_termIndex;
+        read_coded_term(*m_codec, m_buffer.data(), m_offset, m_term, m_docIds);
+        return true;
+    }
+}
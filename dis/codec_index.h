@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "postings_codec.h"
+#include "term_directory.h"
+
+namespace dis
+{
+    /// Header of the compressed index written with one of the postings codecs. Header is followed by the terms, every term
+    /// is its length, bytes, posting count, encoded byte count and the codec coded document id deltas. The terms are followed
+    /// by the term directory.
+    struct CodecIndexHeader
+    {
+        char magic[4];
+        azgra::u32 version;
+        PostingsCodecType codec;
+        azgra::u32 reserved;
+        azgra::u64 termCount;
+    };
+    static_assert(sizeof(CodecIndexHeader) == 24, "Codec index header must keep its size.");
+
+    constexpr char CodecIndexMagic[4] = {'T', 'D', 'A', 'C'};
+    constexpr azgra::u32 CodecIndexVersion = 2;
+
+    /// Check whether the file starts with the codec index magic.
+    bool is_codec_index(const char *path);
+
+    /// Append the term record: term length, bytes, posting count, encoded byte count and the coded document id deltas.
+    /// \param deltas Buffer of the deltas.
+    /// \return Byte offset of the coded deltas.
+    size_t append_coded_term(const PostingsCodec &codec, const std::string_view &term, const azgra::u32 *docIds, const size_t count,
+                             std::vector<azgra::u32> &deltas, std::vector<azgra::byte> &buffer);
+
+    /// Read the term record written by append_coded_term, the data must be padded for the decoder.
+    /// \param offset Offset of the record, moved past it.
+    /// \param term Term viewing the data.
+    /// \param docIds Decoded document ids.
+    void read_coded_term(const PostingsCodec &codec, const azgra::byte *data, size_t &offset, std::string_view &term,
+                         std::vector<azgra::u32> &docIds);
+
+    /// Builds the compressed index in memory and writes it at once.
+    class CodecIndexWriter
+    {
+    private:
+        std::unique_ptr<PostingsCodec> m_codec;
+        CodecIndexHeader m_header{};
+        std::vector<azgra::byte> m_buffer;
+        std::vector<azgra::u32> m_deltas;
+        TermDirectoryWriter m_directory;
+
+    public:
+        explicit CodecIndexWriter(const PostingsCodecType codec);
+
+        /// Append the term with its ascending document ids.
+        void add_term(const std::string_view &term, const azgra::u32 *docIds, const size_t count);
+
+        void write(const char *path);
+    };
+
+    /// Reads terms of the compressed index one by one.
+    class CodecIndexReader
+    {
+    private:
+        std::vector<azgra::byte> m_buffer;
+        std::unique_ptr<PostingsCodec> m_codec;
+        const CodecIndexHeader *m_header = nullptr;
+        size_t m_offset = 0;
+        size_t m_termIndex = 0;
+        std::string_view m_term;
+        std::vector<azgra::u32> m_docIds;
+
+    public:
+        explicit CodecIndexReader(const char *path);
+
+        /// Decode the next term.
+        /// \return False if all terms were read.
+        bool read_next();
+
+        /// Term read last, valid while the reader exists.
+        [[nodiscard]] std::string_view get_term() const
+        { return m_term; }
+
+        [[nodiscard]] const std::vector<azgra::u32> &get_doc_ids() const
+        { return m_docIds; }
+
+        [[nodiscard]] const PostingsCodec &get_codec() const
+        { return *m_codec; }
+
+        [[nodiscard]] size_t get_term_count() const
+        { return m_header->termCount; }
+    };
+}
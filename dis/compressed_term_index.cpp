@@ -0,0 +1,328 @@
+#include "compressed_term_index.h"
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+
+namespace dis
+{
+    PostingCursor::PostingCursor(const CompressedTermIndex &index, const size_t firstBlock, const size_t blockEnd) :
+            m_index(&index), m_firstBlock(firstBlock), m_blockEnd(blockEnd), m_block(firstBlock)
+    {
+    }
+
+    void PostingCursor::load_block(const size_t block)
+    {
+        const azgra::u32 baseDocId = (block == m_firstBlock) ? 0 : m_index->get_block_header(block - 1).lastDocId;
+        m_blockSize = m_index->decode_block(block, baseDocId, m_docIds);
+        m_block = block;
+        m_loadedBlock = block;
+        m_position = 0;
+        ++m_decodedBlockCount;
+    }
+
+    bool PostingCursor::next()
+    {
+        if (m_block >= m_blockEnd)
+            return false;
+        if (m_loadedBlock != m_block)
+        {
+            load_block(m_block);
+            return true;
+        }
+        if ((m_position + 1) < m_blockSize)
+        {
+            ++m_position;
+            return true;
+        }
+        if ((m_block + 1) < m_blockEnd)
+        {
+            load_block(m_block + 1);
+            return true;
+        }
+        m_block = m_blockEnd;
+        return false;
+    }
+
+    bool PostingCursor::advance_to(const azgra::u32 target)
+    {
+        if (m_block >= m_blockEnd)
+            return false;
+
+        size_t block = m_block;
+        if (m_index->get_block_header(block).lastDocId < target)
+        {
+            // Headers of the following blocks are sorted by their last document id.
+            size_t low = block + 1;
+            size_t high = m_blockEnd;
+            while (low < high)
+            {
+                const size_t middle = low + ((high - low) / 2);
+                if (m_index->get_block_header(middle).lastDocId < target)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            if (low == m_blockEnd)
+            {
+                m_block = m_blockEnd;
+                return false;
+            }
+            block = low;
+        }
+        if (block != m_loadedBlock)
+            load_block(block);
+
+        m_position = std::lower_bound(m_docIds + m_position, m_docIds + m_blockSize, target) - m_docIds;
+        return true;
+    }
+
+    CompressedTermIndex::CompressedTermIndex(const PostingsCodecType codec) : m_codec(create_postings_codec(codec))
+    {
+        m_termOffsets.push_back(0);
+        m_termBlocks.push_back(0);
+    }
+
+    void CompressedTermIndex::add_term(const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies,
+                                       const size_t count)
+    {
+        always_assert(!m_finished);
+        always_assert((empty() || (get_term(size() - 1) < term)) && "Terms must be added in ascending order.");
+        if (empty())
+            m_hasFrequencies = (frequencies != nullptr);
+        always_assert((m_hasFrequencies == (frequencies != nullptr)) && "Either all or none of the terms have frequencies.");
+
+        azgra::u32 baseDocId = 0;
+        m_deltas.resize(BlockSize);
+        for (size_t blockBegin = 0; blockBegin < count; blockBegin += BlockSize)
+        {
+            const size_t blockSize = std::min(BlockSize, count - blockBegin);
+            for (size_t i = 0; i < blockSize; ++i)
+            {
+                const azgra::u32 docId = docIds[blockBegin + i];
+                m_deltas[i] = docId - ((i == 0) ? baseDocId : docIds[blockBegin + i - 1]);
+            }
+            m_blockHeaders.push_back(PostingBlockHeader{m_blockData.size(), docIds[blockBegin + blockSize - 1],
+                                                        static_cast<azgra::u32>(blockSize)});
+            m_codec->encode(m_deltas.data(), blockSize, m_blockData);
+            if (m_hasFrequencies)
+            {
+                m_frequencyOffsets.push_back(m_frequencyData.size());
+                m_codec->encode(frequencies + blockBegin, blockSize, m_frequencyData);
+            }
+            baseDocId = docIds[blockBegin + blockSize - 1];
+        }
+
+        m_termData.append(term);
+        m_termOffsets.push_back(m_termData.length());
+        m_termBlocks.push_back(m_blockHeaders.size());
+        m_postingCounts.push_back(static_cast<azgra::u32>(count));
+        m_postingCount += count;
+    }
+
+    void CompressedTermIndex::append(const CompressedTermIndex &other)
+    {
+        always_assert(!m_finished && !other.m_finished);
+        always_assert(m_codec->get_type() == other.m_codec->get_type() && "Blocks must be coded by the same codec.");
+        always_assert((empty() || other.empty() || (get_term(size() - 1) < other.get_term(0))) &&
+                      "Terms must be appended in ascending order.");
+        if (empty())
+            m_hasFrequencies = other.m_hasFrequencies;
+        always_assert((other.empty() || (m_hasFrequencies == other.m_hasFrequencies)) &&
+                      "Either all or none of the terms have frequencies.");
+
+        const azgra::u64 termDataBase = m_termData.length();
+        const azgra::u64 blockBase = m_blockHeaders.size();
+        const azgra::u64 dataBase = m_blockData.size();
+        m_termData.append(other.m_termData);
+        for (size_t i = 1; i < other.m_termOffsets.size(); ++i)
+        {
+            m_termOffsets.push_back(termDataBase + other.m_termOffsets[i]);
+            m_termBlocks.push_back(blockBase + other.m_termBlocks[i]);
+        }
+        m_postingCounts.insert(m_postingCounts.end(), other.m_postingCounts.begin(), other.m_postingCounts.end());
+        for (PostingBlockHeader header : other.m_blockHeaders)
+        {
+            header.dataOffset += dataBase;
+            m_blockHeaders.push_back(header);
+        }
+        m_blockData.insert(m_blockData.end(), other.m_blockData.begin(), other.m_blockData.end());
+        const azgra::u64 frequencyBase = m_frequencyData.size();
+        for (const azgra::u64 frequencyOffset : other.m_frequencyOffsets)
+        {
+            m_frequencyOffsets.push_back(frequencyBase + frequencyOffset);
+        }
+        m_frequencyData.insert(m_frequencyData.end(), other.m_frequencyData.begin(), other.m_frequencyData.end());
+        m_postingCount += other.m_postingCount;
+    }
+
+    void CompressedTermIndex::finish()
+    {
+        always_assert(!m_finished);
+        // Decoders may read past the last block.
+        m_blockData.resize(m_blockData.size() + PostingsCodec::DecodePadding, 0);
+        m_blockData.shrink_to_fit();
+        m_blockHeaders.shrink_to_fit();
+        if (m_hasFrequencies)
+        {
+            m_frequencyData.resize(m_frequencyData.size() + PostingsCodec::DecodePadding, 0);
+            m_frequencyData.shrink_to_fit();
+            m_frequencyOffsets.shrink_to_fit();
+        }
+        m_termData.shrink_to_fit();
+        m_deltas = {};
+        m_finished = true;
+    }
+
+    size_t CompressedTermIndex::find(const std::string_view &term) const
+    {
+        return find_term_rank(term, size(), [this](const size_t rank)
+                              { return get_term(rank); });
+    }
+
+    std::string_view CompressedTermIndex::get_term(const size_t rank) const
+    {
+        return std::string_view(m_termData).substr(m_termOffsets[rank], m_termOffsets[rank + 1] - m_termOffsets[rank]);
+    }
+
+    PostingCursor CompressedTermIndex::get_cursor(const size_t rank) const
+    {
+        always_assert(m_finished && "Index must be finished before it is queried.");
+        return PostingCursor(*this, m_termBlocks[rank], m_termBlocks[rank + 1]);
+    }
+
+    void CompressedTermIndex::decode_postings(const size_t rank, std::vector<azgra::u32> &docIds) const
+    {
+        docIds.resize(m_postingCounts[rank]);
+        azgra::u32 baseDocId = 0;
+        size_t offset = 0;
+        for (size_t block = m_termBlocks[rank]; block < m_termBlocks[rank + 1]; ++block)
+        {
+            offset += decode_block(block, baseDocId, docIds.data() + offset);
+            baseDocId = m_blockHeaders[block].lastDocId;
+        }
+    }
+
+    void CompressedTermIndex::decode_frequencies(const size_t rank, std::vector<azgra::u32> &frequencies) const
+    {
+        always_assert(m_hasFrequencies && "Index doesn't store term frequencies.");
+        frequencies.resize(m_postingCounts[rank]);
+        size_t offset = 0;
+        for (size_t block = m_termBlocks[rank]; block < m_termBlocks[rank + 1]; ++block)
+        {
+            m_codec->decode(m_frequencyData.data() + m_frequencyOffsets[block], m_blockHeaders[block].size,
+                            frequencies.data() + offset);
+            offset += m_blockHeaders[block].size;
+        }
+    }
+
+    size_t CompressedTermIndex::decode_block(const size_t block, const azgra::u32 baseDocId, azgra::u32 *docIds) const
+    {
+        const PostingBlockHeader &header = m_blockHeaders[block];
+        m_codec->decode(m_blockData.data() + header.dataOffset, header.size, docIds);
+        azgra::u32 docId = baseDocId;
+        for (size_t i = 0; i < header.size; ++i)
+        {
+            docId += docIds[i];
+            docIds[i] = docId;
+        }
+        return header.size;
+    }
+
+    azgra::u32 CompressedTermIndex::get_max_doc_id() const
+    {
+        azgra::u32 maxDocId = 0;
+        for (size_t rank = 0; rank < size(); ++rank)
+        {
+            if (m_termBlocks[rank + 1] != m_termBlocks[rank])
+                maxDocId = std::max(maxDocId, m_blockHeaders[m_termBlocks[rank + 1] - 1].lastDocId);
+        }
+        return maxDocId;
+    }
+
+    size_t CompressedTermIndex::get_memory_bytes() const
+    {
+        return m_termData.capacity() + (m_termOffsets.capacity() * sizeof(azgra::u64)) +
+               (m_termBlocks.capacity() * sizeof(azgra::u64)) + (m_postingCounts.capacity() * sizeof(azgra::u32)) +
+               (m_blockHeaders.capacity() * sizeof(PostingBlockHeader)) + m_blockData.capacity() +
+               (m_frequencyOffsets.capacity() * sizeof(azgra::u64)) + m_frequencyData.capacity();
+    }
+
+    void test_compressed_term_index()
+    {
+        std::mt19937 generator(42);
+        std::vector<std::vector<azgra::u32>> lists;
+        for (const size_t count : {1, 3, 128, 129, 1000, 50000})
+        {
+            std::set<azgra::u32> docIds;
+            while (docIds.size() < count)
+                docIds.insert(1 + (generator() % 200000));
+            lists.emplace_back(docIds.begin(), docIds.end());
+        }
+
+        CompressedTermIndex index;
+        for (size_t term = 0; term < lists.size(); ++term)
+            index.add_term(std::string(1, static_cast<char>('a' + term)), lists[term].data(), lists[term].size());
+        index.finish();
+
+        size_t failed = 0;
+        for (size_t lead = 0; lead < lists.size(); ++lead)
+        {
+            for (size_t other = lead + 1; other < lists.size(); ++other)
+            {
+                std::vector<azgra::u32> expected;
+                std::set_intersection(lists[lead].begin(), lists[lead].end(), lists[other].begin(), lists[other].end(),
+                                      std::back_inserter(expected));
+                std::vector<azgra::u32> intersection;
+                PostingCursor leadCursor = index.get_cursor(lead);
+                PostingCursor otherCursor = index.get_cursor(other);
+                bool hasCandidate = leadCursor.next();
+                while (hasCandidate && otherCursor.advance_to(leadCursor.doc_id()))
+                {
+                    if (otherCursor.doc_id() == leadCursor.doc_id())
+                    {
+                        intersection.push_back(leadCursor.doc_id());
+                        hasCandidate = leadCursor.next();
+                    }
+                    else
+                    {
+                        hasCandidate = leadCursor.advance_to(otherCursor.doc_id());
+                    }
+                }
+                if (intersection != expected)
+                    ++failed;
+            }
+        }
+
+        // Frequencies are coded in their own blocks and must come back in the order of the document ids.
+        CompressedTermIndex frequencyIndex;
+        for (size_t term = 0; term < lists.size(); ++term)
+        {
+            std::vector<azgra::u32> frequencies(lists[term].size());
+            for (size_t i = 0; i < frequencies.size(); ++i)
+                frequencies[i] = 1 + (lists[term][i] % 7);
+            frequencyIndex.add_term(std::string(1, static_cast<char>('a' + term)), lists[term].data(), frequencies.data(),
+                                    lists[term].size());
+        }
+        frequencyIndex.finish();
+        std::vector<azgra::u32> frequencies;
+        for (size_t term = 0; term < lists.size(); ++term)
+        {
+            frequencyIndex.decode_frequencies(term, frequencies);
+            for (size_t i = 0; i < frequencies.size(); ++i)
+            {
+                if (frequencies[i] != (1 + (lists[term][i] % 7)))
+                {
+                    ++failed;
+                    break;
+                }
+            }
+        }
+
+        if (failed == 0)
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Compressed index intersections and frequencies OK\n");
+        else
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red,
+                                   "Compressed index failed %lu intersections or frequency lists\n", failed);
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "postings_codec.h"
+#include "term_rank.h"
+
+namespace dis
+{
+    /// Header of one block of compressed document ids.
+    struct PostingBlockHeader
+    {
+        /// Byte offset of the encoded block.
+        azgra::u64 dataOffset;
+        /// Last document id of the block, blocks before the target can be skipped without decoding.
+        azgra::u32 lastDocId;
+        /// Number of document ids in the block.
+        azgra::u32 size;
+    };
+
+    class CompressedTermIndex;
+
+    /// Forward cursor over the postings of one term. Blocks are decoded only when the cursor lands in them.
+    class PostingCursor
+    {
+    private:
+        static constexpr size_t NoBlock = static_cast<size_t>(-1);
+
+        const CompressedTermIndex *m_index;
+        size_t m_firstBlock;
+        size_t m_blockEnd;
+        size_t m_block;
+        size_t m_loadedBlock = NoBlock;
+        size_t m_position = 0;
+        size_t m_blockSize = 0;
+        size_t m_decodedBlockCount = 0;
+        azgra::u32 m_docIds[PForCodec::BlockSize]{};
+
+        void load_block(const size_t block);
+
+    public:
+        PostingCursor(const CompressedTermIndex &index, const size_t firstBlock, const size_t blockEnd);
+
+        /// Move to the next posting, the first call moves to the first posting.
+        /// \return False if there are no more postings.
+        bool next();
+
+        /// Move to the first posting with document id greater or equal to target, the cursor never moves back. Blocks
+        /// ending before the target are skipped by their headers.
+        /// \return False if there is no such posting.
+        bool advance_to(const azgra::u32 target);
+
+        /// Document id of the current posting.
+        [[nodiscard]] azgra::u32 doc_id() const
+        { return m_docIds[m_position]; }
+
+        [[nodiscard]] size_t get_block_count() const
+        { return m_blockEnd - m_firstBlock; }
+
+        [[nodiscard]] size_t get_decoded_block_count() const
+        { return m_decodedBlockCount; }
+    };
+
+    /// Inverted index with document ids compressed in blocks of 128, every block has a header with its last document id
+    /// and offset. Terms are sorted and addressed by rank. Term frequencies are coded in blocks of their own when they are
+    /// known, the compressed index files don't store them.
+    class CompressedTermIndex
+    {
+    private:
+        std::unique_ptr<PostingsCodec> m_codec;
+        std::string m_termData;
+        std::vector<azgra::u64> m_termOffsets;
+        std::vector<azgra::u64> m_termBlocks;
+        std::vector<azgra::u32> m_postingCounts;
+        std::vector<PostingBlockHeader> m_blockHeaders;
+        std::vector<azgra::byte> m_blockData;
+        /// Offsets of the coded frequencies of every block, empty without frequencies.
+        std::vector<azgra::u64> m_frequencyOffsets;
+        std::vector<azgra::byte> m_frequencyData;
+        std::vector<azgra::u32> m_deltas;
+        size_t m_postingCount = 0;
+        bool m_hasFrequencies = false;
+        bool m_finished = false;
+
+    public:
+        static constexpr size_t NotFound = TermNotFound;
+        static constexpr size_t BlockSize = PForCodec::BlockSize;
+
+        explicit CompressedTermIndex(const PostingsCodecType codec = PostingsCodecType::PFor);
+
+        CompressedTermIndex(const CompressedTermIndex &) = delete;
+
+        CompressedTermIndex &operator=(const CompressedTermIndex &) = delete;
+
+        /// Append the term with its ascending document ids, terms must be added in ascending order.
+        void add_term(const std::string_view &term, const azgra::u32 *docIds, const size_t count)
+        { add_term(term, docIds, nullptr, count); }
+
+        /// Append the term with its ascending document ids and their frequencies, terms must be added in ascending order.
+        /// Either all or none of the terms have frequencies.
+        /// \param frequencies Term frequencies of the documents or nullptr.
+        void add_term(const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies, const size_t count);
+
+        /// Append all terms of the other unfinished index, its terms must follow the terms of this index.
+        void append(const CompressedTermIndex &other);
+
+        /// Finish building, no more terms can be added.
+        void finish();
+
+        /// Find rank of the term by binary search in the term table.
+        /// \return Rank of the term or NotFound.
+        [[nodiscard]] size_t find(const std::string_view &term) const;
+
+        [[nodiscard]] std::string_view get_term(const size_t rank) const;
+
+        [[nodiscard]] size_t get_posting_count(const size_t rank) const
+        { return m_postingCounts[rank]; }
+
+        [[nodiscard]] PostingCursor get_cursor(const size_t rank) const;
+
+        /// Decode all document ids of the term.
+        void decode_postings(const size_t rank, std::vector<azgra::u32> &docIds) const;
+
+        /// Whether the term frequencies were stored with the document ids.
+        [[nodiscard]] bool has_frequencies() const
+        { return m_hasFrequencies; }
+
+        /// Decode frequencies of all documents of the term, only valid if the index has frequencies.
+        void decode_frequencies(const size_t rank, std::vector<azgra::u32> &frequencies) const;
+
+        [[nodiscard]] const PostingBlockHeader &get_block_header(const size_t block) const
+        { return m_blockHeaders[block]; }
+
+        /// Decode the block.
+        /// \param block Global index of the block.
+        /// \param baseDocId Last document id of the previous block of the term, zero for the first block.
+        /// \param docIds Output of the block size document ids.
+        /// \return Number of decoded document ids.
+        size_t decode_block(const size_t block, const azgra::u32 baseDocId, azgra::u32 *docIds) const;
+
+        [[nodiscard]] const PostingsCodec &get_codec() const
+        { return *m_codec; }
+
+        [[nodiscard]] size_t size() const
+        { return m_postingCounts.size(); }
+
+        [[nodiscard]] bool empty() const
+        { return m_postingCounts.empty(); }
+
+        [[nodiscard]] size_t get_posting_count() const
+        { return m_postingCount; }
+
+        [[nodiscard]] size_t get_block_count() const
+        { return m_blockHeaders.size(); }
+
+        /// Largest document id of all postings read from the block headers, zero if the index is empty.
+        [[nodiscard]] azgra::u32 get_max_doc_id() const;
+
+        [[nodiscard]] size_t get_memory_bytes() const;
+    };
+
+    void test_compressed_term_index();
+}
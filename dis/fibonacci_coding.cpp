@@ -0,0 +1,499 @@
+#include "fibonacci_coding.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <azgra/collection/enumerable.h>
+
+namespace dis
+{
+    static constexpr FibonacciTable Fibonacci = {};
+
+    /// Values of the Zeckendorf digits of every byte of the code, one table for each of the six bytes of the longest code.
+    struct FibonacciByteTable
+    {
+        static constexpr size_t ByteCount = 6;
+        azgra::u64 values[ByteCount][256]{};
+
+        constexpr FibonacciByteTable()
+        {
+            for (size_t byte = 0; byte < ByteCount; ++byte)
+            {
+                for (size_t bits = 0; bits < 256; ++bits)
+                {
+                    for (size_t bit = 0; bit < 8; ++bit)
+                    {
+                        const size_t index = (byte * 8) + bit;
+                        if ((bits & (1u << bit)) && (index < FibonacciTable::Size))
+                            values[byte][bits] += Fibonacci.numbers[index];
+                    }
+                }
+            }
+        }
+    };
+
+    static constexpr FibonacciByteTable FibonacciBytes = {};
+
+    static constexpr FibonacciCode encode_zeckendorf(const azgra::u32 value)
+    {
+        size_t index = FibonacciTable::Size - 1;
+        while (Fibonacci.numbers[index] > value)
+            --index;
+        const size_t highestIndex = index;
+
+        azgra::u64 digits = 0;
+        azgra::u64 remaining = value;
+        while (remaining > 0)
+        {
+            digits |= (1ull << index);
+            remaining -= Fibonacci.numbers[index];
+            // Next digit is never the neighbouring one.
+            index = (index >= 2) ? (index - 2) : 0;
+            while ((index > 0) && (Fibonacci.numbers[index] > remaining))
+                --index;
+        }
+        return FibonacciCode{digits | (1ull << (highestIndex + 1)), static_cast<int>(highestIndex) + 2};
+    }
+
+    /// Codes of the small values, which are the most of document id deltas.
+    struct FibonacciEncodeTable
+    {
+        static constexpr size_t Size = 4096;
+        FibonacciCode codes[Size]{};
+
+        constexpr FibonacciEncodeTable()
+        {
+            for (size_t value = 1; value < Size; ++value)
+                codes[value] = encode_zeckendorf(static_cast<azgra::u32>(value));
+        }
+    };
+
+    static constexpr FibonacciEncodeTable FibonacciCodes = {};
+
+    FibonacciCode fibonacci_encode(const azgra::u32 value)
+    {
+        always_assert(value > 0 && "Fibonacci coding can't represent zero.");
+        if (value < FibonacciEncodeTable::Size)
+            return FibonacciCodes.codes[value];
+        return encode_zeckendorf(value);
+    }
+
+    azgra::u32 fibonacci_decode(const azgra::u64 window, int &length)
+    {
+        // Zeckendorf digits never contain two ones in a row, the first pair is the end of the code.
+        const azgra::u64 ends = window & (window >> 1);
+        always_assert(ends != 0 && "Incomplete Fibonacci code.");
+        const int lastDigit = __builtin_ctzll(ends);
+        length = lastDigit + 2;
+
+        azgra::u64 digits = window & ((2ull << lastDigit) - 1);
+        azgra::u64 value = 0;
+        for (size_t byte = 0; digits != 0; ++byte, digits >>= 8)
+        {
+            value += FibonacciBytes.values[byte][digits & 0xFF];
+        }
+        return static_cast<azgra::u32>(value);
+    }
+
+    struct BitReverseTable
+    {
+        azgra::byte bytes[256]{};
+
+        constexpr BitReverseTable()
+        {
+            for (size_t byte = 0; byte < 256; ++byte)
+            {
+                for (size_t bit = 0; bit < 8; ++bit)
+                {
+                    if (byte & (1u << bit))
+                        bytes[byte] |= static_cast<azgra::byte>(0x80u >> bit);
+                }
+            }
+        }
+    };
+
+    static constexpr BitReverseTable BitReverse = {};
+
+    static azgra::u32 reverse_bits(const azgra::u32 value, const int bitCount)
+    {
+        azgra::u32 reversed = 0;
+        for (int byte = 0; byte < 4; ++byte)
+        {
+            reversed |= static_cast<azgra::u32>(BitReverse.bytes[(value >> (8 * byte)) & 0xFF]) << (8 * (3 - byte));
+        }
+        return reversed >> (32 - bitCount);
+    }
+
+    BitWriter::BitWriter(const BitStreamLayout &layout) : m_layout(layout)
+    {
+    }
+
+    void BitWriter::write_bits(const azgra::u64 bits, const int count)
+    {
+        m_bits |= bits << m_bitCount;
+        m_bitCount += count;
+        while (m_bitCount >= 8)
+        {
+            const auto byte = static_cast<azgra::byte>(m_bits);
+            m_buffer.push_back(m_layout.msbFirstBytes ? BitReverse.bytes[byte] : byte);
+            m_bits >>= 8;
+            m_bitCount -= 8;
+        }
+    }
+
+    void BitWriter::write_value(const azgra::u32 value, const int bitCount)
+    {
+        write_bits(m_layout.msbFirstValues ? reverse_bits(value, bitCount) : value, bitCount);
+    }
+
+    void BitWriter::align()
+    {
+        if (m_bitCount > 0)
+            write_bits(0, 8 - m_bitCount);
+    }
+
+    std::vector<azgra::byte> BitWriter::finish()
+    {
+        align();
+        return std::move(m_buffer);
+    }
+
+    BitReader::BitReader(const azgra::byte *data, const size_t size, const BitStreamLayout &layout) :
+            m_layout(layout), m_data(data), m_size(size)
+    {
+    }
+
+    azgra::u64 BitReader::peek() const
+    {
+        const size_t bytePosition = m_bitPosition / 8;
+        azgra::u64 window = 0;
+        if ((bytePosition + sizeof(window) <= m_size) && !m_layout.msbFirstBytes)
+        {
+            memcpy(&window, m_data + bytePosition, sizeof(window));
+        }
+        else
+        {
+            for (size_t byte = 0; (byte < sizeof(window)) && ((bytePosition + byte) < m_size); ++byte)
+            {
+                const azgra::byte value = m_data[bytePosition + byte];
+                window |= static_cast<azgra::u64>(m_layout.msbFirstBytes ? BitReverse.bytes[value] : value) << (8 * byte);
+            }
+        }
+        return window >> (m_bitPosition % 8);
+    }
+
+    azgra::u32 BitReader::read_value(const int bitCount)
+    {
+        const auto value = static_cast<azgra::u32>(peek() & ((1ull << bitCount) - 1));
+        skip(bitCount);
+        return m_layout.msbFirstValues ? reverse_bits(value, bitCount) : value;
+    }
+
+    static std::optional<BitStreamLayout> detect_bit_stream_layout()
+    {
+        azgra::io::stream::OutMemoryBitStream bitStream;
+        bitStream << true;
+        bitStream.write_value<azgra::u32>(0x8F31A2C5u);
+        bitStream.write_value<azgra::byte>(0x5A);
+        bitStream << false << true << true;
+        const auto expected = bitStream.get_flushed_buffer();
+
+        for (const bool msbFirstBytes : {false, true})
+        {
+            for (const bool msbFirstValues : {false, true})
+            {
+                BitWriter writer(BitStreamLayout{msbFirstBytes, msbFirstValues});
+                writer.write_bits(1, 1);
+                writer.write_value(0x8F31A2C5u, 32);
+                writer.write_value(0x5A, 8);
+                writer.write_bits(0b110, 3);
+                const auto written = writer.finish();
+                if (std::equal(written.begin(), written.end(), expected.begin(), expected.end()))
+                    return BitStreamLayout{msbFirstBytes, msbFirstValues};
+            }
+        }
+        return std::nullopt;
+    }
+
+    const BitStreamLayout *get_bit_stream_layout()
+    {
+        static const std::optional<BitStreamLayout> layout = detect_bit_stream_layout();
+        return layout.has_value() ? &layout.value() : nullptr;
+    }
+
+    FibonacciIndexWriter::FibonacciIndexWriter(const BitStreamLayout &layout) : m_writer(layout)
+    {
+    }
+
+    void FibonacciIndexWriter::add_term(const std::string_view &term, const azgra::u32 *docIds, const size_t count)
+    {
+        m_writer.write_value(static_cast<azgra::u32>(term.length()), 32);
+        for (const char c : term)
+        {
+            m_writer.write_value(static_cast<azgra::byte>(c), 8);
+        }
+        always_assert(count <= std::numeric_limits<azgra::u32>::max());
+        m_writer.write_value(static_cast<azgra::u32>(count), 32);
+        m_directory.add_term(term, m_writer.get_bit_count(), count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const FibonacciCode code = fibonacci_encode((i == 0) ? docIds[i] : (docIds[i] - docIds[i - 1]));
+            m_writer.write_bits(code.bits, code.length);
+        }
+    }
+
+    std::vector<azgra::byte> FibonacciIndexWriter::finish(const bool withDirectory)
+    {
+        m_writer.write_value(0, 32);
+        std::vector<azgra::byte> buffer = m_writer.finish();
+        if (withDirectory)
+            m_directory.append_to(buffer);
+        return buffer;
+    }
+
+    FibonacciIndexReader::FibonacciIndexReader(const std::vector<azgra::byte> &buffer, const BitStreamLayout &layout) :
+            m_reader(buffer.data(), buffer.size(), layout)
+    {
+    }
+
+    bool FibonacciIndexReader::read_next()
+    {
+        const azgra::u32 termLength = m_reader.read_value(32);
+        if (termLength == 0)
+            return false;
+        m_term.resize(termLength);
+        for (char &c : m_term)
+        {
+            c = static_cast<char>(m_reader.read_value(8));
+        }
+
+        m_docIds.resize(m_reader.read_value(32));
+        azgra::u32 docId = 0;
+        for (auto &id : m_docIds)
+        {
+            int codeLength;
+            docId += fibonacci_decode(m_reader.peek(), codeLength);
+            m_reader.skip(codeLength);
+            id = docId;
+        }
+        return true;
+    }
+
+    static std::pair<size_t, size_t> largest_lte_fib_num_index(const std::vector<size_t> &fibSeq,
+                                                               const size_t target,
+                                                               const size_t maxExclusiveIndex)
+    {
+        always_assert(maxExclusiveIndex > 1);
+        for (size_t i = maxExclusiveIndex; i-- > 0;)
+        {
+            if (fibSeq[i] <= target)
+            {
+                //return <value,index>
+                return std::make_pair(fibSeq[i], i);// (maxExclusiveIndex - 1 - i));
+            }
+        }
+        always_assert(false && "Didn't find fibonacci number!");
+        return std::make_pair(-1, -1);
+    }
+
+    void encode_delta_with_fibonacci_sequence(azgra::io::stream::OutMemoryBitStream &bitStream,
+                                              const std::string &term,
+                                              const std::vector<DocId> &delta,
+                                              const std::vector<size_t> &fibSeq)
+    {
+        // Write term
+        const auto termLen = static_cast<azgra::u32>(term.length());
+        bitStream.write_value(termLen);
+        for (const char &c : term)
+        {
+            bitStream.write_value<azgra::byte>(c);
+        }
+        always_assert(delta.size() <= std::numeric_limits<azgra::u32>::max());
+        auto deltaSize = static_cast<azgra::u32> (delta.size());
+        bitStream.write_value(deltaSize);
+
+        for (const DocId &value : delta)
+        {
+            long remaining = static_cast<long> (value);
+            std::vector<size_t> fibIndicis;
+            size_t maxIndex = fibSeq.size();
+            while (remaining > 0)
+            {
+                auto[value, index] = largest_lte_fib_num_index(fibSeq, remaining, maxIndex);
+                fibIndicis.push_back(index);
+                remaining -= value;
+            }
+            const size_t maxFibIndex = azgra::collection::max(fibIndicis.begin(), fibIndicis.end());
+            for (size_t i = 0; i <= maxFibIndex; ++i)
+            {
+                // Index is set write 1
+                const bool bit = std::find(fibIndicis.begin(), fibIndicis.end(), i) != fibIndicis.end();
+                bitStream << bit;
+            }
+            // Write terminating 1.
+            bitStream << true;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::vector<DocId>>>
+    decode_deltas_from_fibonacci_sequence(azgra::io::stream::InMemoryBitStream &bitStream, std::vector<size_t> &fibSeq)
+    {
+        std::vector<std::pair<std::string, std::vector<DocId>>> deltas;
+        auto termLen = bitStream.read_value<azgra::u32>();
+        std::vector<char> termData(termLen);
+        for (size_t i = 0; i < termLen; ++i)
+        {
+            termData[i] = bitStream.read_value<azgra::byte>();
+        }
+        std::string term = std::string(termData.data(), termLen);
+
+        auto deltaSize = bitStream.read_value<azgra::u32>();
+        do
+        {
+
+            int deltaValueRemaining = deltaSize;
+            std::vector<DocId> delta;
+            bool prevWasOne = false;
+            std::vector<size_t> fibIndices;
+            long index = -1;
+
+            while (deltaValueRemaining)
+            {
+                ++index;
+                if (bitStream.read_bit())   // 1
+                {
+                    if (prevWasOne)
+                    {
+                        // If previous was one reset here and decode from indices.
+                        size_t result = 0;
+                        for (const size_t &fibIndex : fibIndices)
+                        {
+                            result += fibSeq[fibIndex];
+                        }
+                        delta.push_back(result);
+
+                        --deltaValueRemaining;
+                        index = -1;
+                        fibIndices.clear();
+                        prevWasOne = false;
+                    }
+                    else
+                    {
+                        prevWasOne = true;
+                        fibIndices.push_back(index);
+                    }
+                }
+                else                        // 0
+                {
+                    prevWasOne = false;
+                }
+            }
+            always_assert (delta.size() == static_cast<size_t>(deltaSize));
+            deltas.emplace_back(term, delta);
+
+            termLen = bitStream.read_value<azgra::u32>();
+            if (termLen == 0)
+            {
+                break;
+            }
+            termData.resize(termLen);
+            for (size_t i = 0; i < termLen; ++i)
+            {
+                termData[i] = bitStream.read_value<azgra::byte>();
+            }
+            term = std::string(termData.data(), termLen);
+            deltaSize = bitStream.read_value<azgra::u32>();
+        } while (deltaSize);
+        return deltas;
+    }
+
+    std::vector<size_t> generate_fibonacci_sequence(const size_t N)
+    {
+        int n = N + 1;
+        std::vector<size_t> fibN(N);
+        size_t a = 0;
+        size_t b = 1;
+        size_t i = 0;
+        while (n-- > 1)
+        {
+            size_t t = a;
+            a = b;
+            b += t;
+            fibN[i++] = b;
+        }
+        //return b;
+        return fibN;
+    }
+
+    void test_fibonacci_coding()
+    {
+        std::mt19937 generator(7);
+        std::vector<std::pair<std::string, std::vector<azgra::u32>>> terms;
+        for (size_t term = 0; term < 200; ++term)
+        {
+            std::vector<azgra::u32> docIds(1 + (generator() % 300));
+            azgra::u32 docId = 0;
+            for (auto &id : docIds)
+            {
+                // Mostly small gaps, some above the encode table and the largest possible ones.
+                const azgra::u32 gap = ((generator() % 64) == 0) ? static_cast<azgra::u32>(generator() % 100000000) : (generator() % 50);
+                docId += 1 + gap;
+                id = docId;
+            }
+            terms.emplace_back("term" + std::to_string(term), std::move(docIds));
+        }
+        terms.emplace_back("max", std::vector<azgra::u32>{std::numeric_limits<azgra::u32>::max()});
+
+        size_t failed = 0;
+        const BitStreamLayout *layout = get_bit_stream_layout();
+        if (layout == nullptr)
+        {
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Yellow, "Bit stream layout is unknown, bit serial coding is used\n");
+        }
+        else
+        {
+            // Table driven writer must produce the same bytes as the original encoder.
+            auto fibSeq = generate_fibonacci_sequence(50);
+            azgra::io::stream::OutMemoryBitStream bitStream;
+            FibonacciIndexWriter writer(*layout);
+            for (const auto &[term, docIds] : terms)
+            {
+                std::vector<DocId> delta(docIds.size());
+                for (size_t i = 0; i < docIds.size(); ++i)
+                    delta[i] = (i == 0) ? docIds[i] : (docIds[i] - docIds[i - 1]);
+                encode_delta_with_fibonacci_sequence(bitStream, term, delta, fibSeq);
+                writer.add_term(term, docIds.data(), docIds.size());
+            }
+            bitStream.write_value<azgra::u32>(0);
+            const auto expected = bitStream.get_flushed_buffer();
+            const auto written = writer.finish();
+            if (!std::equal(written.begin(), written.end(), expected.begin(), expected.end()))
+            {
+                ++failed;
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Table driven Fibonacci index differs from the original\n");
+            }
+
+            FibonacciIndexReader reader(written, *layout);
+            for (const auto &[term, docIds] : terms)
+            {
+                if (!reader.read_next() || (reader.get_term() != term) || (reader.get_doc_ids() != docIds))
+                {
+                    ++failed;
+                    azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Term %s wasn't decoded\n", term.c_str());
+                }
+            }
+            if (reader.read_next())
+                ++failed;
+        }
+
+        for (azgra::u32 value = 1; value < 100000; value += 1 + (value / 64))
+        {
+            const FibonacciCode code = fibonacci_encode(value);
+            int length;
+            if ((fibonacci_decode(code.bits, length) != value) || (length != code.length))
+                ++failed;
+        }
+        if (failed == 0)
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Table driven Fibonacci coding round trip OK\n");
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <azgra/io/stream/memory_bit_stream.h>
+#include "term_index.h"
+#include "term_directory.h"
+
+namespace dis
+{
+    /// Fibonacci numbers 1, 2, 3, 5, ... up to the first one above the u32 range.
+    struct FibonacciTable
+    {
+        static constexpr size_t Size = 47;
+        azgra::u64 numbers[Size]{};
+
+        constexpr FibonacciTable()
+        {
+            numbers[0] = 1;
+            numbers[1] = 2;
+            for (size_t i = 2; i < Size; ++i)
+                numbers[i] = numbers[i - 1] + numbers[i - 2];
+        }
+    };
+
+    /// Fibonacci code of one value, the Zeckendorf digits from the smallest Fibonacci number followed by terminating one.
+    /// The first bit of the code is the least significant one.
+    struct FibonacciCode
+    {
+        azgra::u64 bits;
+        int length;
+    };
+
+    /// Encode the positive value, small values are read from the precomputed table.
+    FibonacciCode fibonacci_encode(const azgra::u32 value);
+
+    /// Decode the first code of the bit window, whose first bit is the least significant one. The code must be complete,
+    /// codes are at most 48 bits long.
+    /// \param window Bits of the stream.
+    /// \param length Number of bits of the decoded code.
+    /// \return Decoded value.
+    azgra::u32 fibonacci_decode(const azgra::u64 window, int &length);
+
+    /// Order of bits written by the bit streams.
+    struct BitStreamLayout
+    {
+        /// First bit of the byte is its most significant one.
+        bool msbFirstBytes = false;
+        /// Values are written from their most significant bit.
+        bool msbFirstValues = false;
+    };
+
+    /// Layout of the azgra bit streams, detected once by writing a known sequence through OutMemoryBitStream.
+    /// \return Layout or nullptr if the stream can't be reproduced and the bit serial coding has to be used.
+    const BitStreamLayout *get_bit_stream_layout();
+
+    /// Bit writer collecting up to 64 bits at once, bytes are emitted in the given layout.
+    class BitWriter
+    {
+    private:
+        BitStreamLayout m_layout;
+        std::vector<azgra::byte> m_buffer;
+        azgra::u64 m_bits = 0;
+        int m_bitCount = 0;
+
+    public:
+        explicit BitWriter(const BitStreamLayout &layout = {});
+
+        /// Write bits in the stream order, the first one is the least significant one.
+        /// \param bits Bits to write.
+        /// \param count Number of bits, at most 56.
+        void write_bits(const azgra::u64 bits, const int count);
+
+        /// Write value in the same way as OutMemoryBitStream::write_value.
+        void write_value(const azgra::u32 value, const int bitCount);
+
+        /// Pad the last byte with zeros.
+        void align();
+
+        /// Align and release the written bytes.
+        std::vector<azgra::byte> finish();
+
+        [[nodiscard]] size_t get_byte_count() const
+        { return m_buffer.size(); }
+
+        [[nodiscard]] azgra::u64 get_bit_count() const
+        { return (m_buffer.size() * 8) + m_bitCount; }
+    };
+
+    /// Bit reader returning windows of the following bits.
+    class BitReader
+    {
+    private:
+        BitStreamLayout m_layout;
+        const azgra::byte *m_data;
+        size_t m_size;
+        size_t m_bitPosition = 0;
+
+    public:
+        BitReader(const azgra::byte *data, const size_t size, const BitStreamLayout &layout = {});
+
+        /// Get at least 56 following bits, the first one is the least significant one. Bits past the end are zero.
+        [[nodiscard]] azgra::u64 peek() const;
+
+        void skip(const size_t bitCount)
+        { m_bitPosition += bitCount; }
+
+        /// Read value written by OutMemoryBitStream::write_value.
+        azgra::u32 read_value(const int bitCount);
+
+        [[nodiscard]] size_t get_byte_position() const
+        { return (m_bitPosition + 7) / 8; }
+    };
+
+    /// Writes compressed index byte compatible with the original Fibonacci format of dump_compressed_index.
+    class FibonacciIndexWriter
+    {
+    private:
+        BitWriter m_writer;
+        TermDirectoryWriter m_directory;
+
+    public:
+        explicit FibonacciIndexWriter(const BitStreamLayout &layout);
+
+        /// Append the term with its ascending document ids.
+        void add_term(const std::string_view &term, const azgra::u32 *docIds, const size_t count);
+
+        /// Write the terminating empty term and release the bytes.
+        /// \param withDirectory Append the term directory with bit offsets of the terms, used by the lazy loading.
+        std::vector<azgra::byte> finish(const bool withDirectory = false);
+    };
+
+    /// Reads compressed index in the original Fibonacci format term by term.
+    class FibonacciIndexReader
+    {
+    private:
+        BitReader m_reader;
+        std::string m_term;
+        std::vector<azgra::u32> m_docIds;
+
+    public:
+        FibonacciIndexReader(const std::vector<azgra::byte> &buffer, const BitStreamLayout &layout);
+
+        /// Decode the next term.
+        /// \return False if all terms were read.
+        bool read_next();
+
+        [[nodiscard]] const std::string &get_term() const
+        { return m_term; }
+
+        [[nodiscard]] const std::vector<azgra::u32> &get_doc_ids() const
+        { return m_docIds; }
+    };
+
+    std::vector<size_t> generate_fibonacci_sequence(const size_t n);
+
+    /// Original bit serial encoding of one term, the reference of the table driven coding.
+    void encode_delta_with_fibonacci_sequence(azgra::io::stream::OutMemoryBitStream &bitStream,
+                                              const std::string &term,
+                                              const std::vector<DocId> &delta,
+                                              const std::vector<size_t> &fibSeq);
+
+    /// Original bit serial decoding of all terms, the reference of the table driven coding.
+    std::vector<std::pair<std::string, std::vector<DocId>>>
+    decode_deltas_from_fibonacci_sequence(azgra::io::stream::InMemoryBitStream &bitStream, std::vector<size_t> &fibSeq);
+
+    void test_fibonacci_coding();
+}
@@ -0,0 +1,301 @@
+#include "frozen_term_index.h"
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+namespace dis
+{
+    FrozenTermIndex::FrozenTermIndex()
+    {
+        m_termOffsets.push_back(0);
+        m_postingOffsets.push_back(0);
+    }
+
+    void FrozenTermIndex::add_term(const std::string_view &term, const TermId termId)
+    {
+        m_termData.append(term);
+        always_assert(m_termData.length() <= std::numeric_limits<azgra::u32>::max());
+        m_termOffsets.push_back(static_cast<azgra::u32>(m_termData.length()));
+        m_termIds.push_back(termId);
+    }
+
+    void FrozenTermIndex::finish_term()
+    {
+        m_postingOffsets.push_back(m_docIds.size());
+    }
+
+    void FrozenTermIndex::shrink_to_fit()
+    {
+        m_termData.shrink_to_fit();
+        m_termOffsets.shrink_to_fit();
+        m_termIds.shrink_to_fit();
+        m_postingOffsets.shrink_to_fit();
+        m_docIds.shrink_to_fit();
+        m_frequencies.shrink_to_fit();
+        m_positionOffsets.shrink_to_fit();
+        m_positionData.shrink_to_fit();
+    }
+
+    FrozenTermIndex::FrozenTermIndex(const TermIndex &index) : FrozenTermIndex()
+    {
+        m_dictionary = index.get_shared_dictionary();
+        const bool positional = index.is_positional();
+        if (positional)
+        {
+            m_positionOffsets.push_back(0);
+        }
+
+        const auto sortedTermIds = index.get_sorted_term_ids();
+        m_termIds.reserve(sortedTermIds.size());
+        for (const TermId termId : sortedTermIds)
+        {
+            add_term(index.get_dictionary().get_term(termId), termId);
+
+            const auto &termPositions = index.get_document_positions(termId);
+            auto positionsIt = termPositions.begin();
+            for (const DocumentOccurence &occurence : index.get_postings(termId))
+            {
+                always_assert(occurence.docId <= std::numeric_limits<azgra::u32>::max());
+                m_docIds.push_back(static_cast<azgra::u32>(occurence.docId));
+                m_frequencies.push_back(static_cast<azgra::u32>(occurence.occurenceCount));
+                if (!positional)
+                    continue;
+
+                // Loaded indices have postings without positions, those get an empty position list.
+                while ((positionsIt != termPositions.end()) && (positionsIt->docId < occurence.docId))
+                    ++positionsIt;
+                if ((positionsIt != termPositions.end()) && (positionsIt->docId == occurence.docId))
+                {
+                    m_positionData.insert(m_positionData.end(), positionsIt->encodedPositions.begin(),
+                                          positionsIt->encodedPositions.end());
+                }
+                m_positionOffsets.push_back(m_positionData.size());
+            }
+            finish_term();
+        }
+        shrink_to_fit();
+    }
+
+    FrozenTermIndex::FrozenTermIndex(std::shared_ptr<TermDictionary> dictionary) : FrozenTermIndex()
+    {
+        m_dictionary = std::move(dictionary);
+    }
+
+    void FrozenTermIndex::append_term(const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies,
+                                      const size_t count)
+    {
+        always_assert((empty() || (get_term(size() - 1) < term)) && "Terms must be appended in ascending order.");
+        add_term(term, m_dictionary->intern(term));
+        m_docIds.insert(m_docIds.end(), docIds, docIds + count);
+        m_frequencies.insert(m_frequencies.end(), frequencies, frequencies + count);
+        finish_term();
+    }
+
+    DocId FrozenTermIndex::get_max_doc_id() const
+    {
+        azgra::u32 maxDocId = 0;
+        for (size_t rank = 0; rank < size(); ++rank)
+        {
+            // Postings are sorted, so the last one of every term is its largest document id.
+            if (m_postingOffsets[rank + 1] != m_postingOffsets[rank])
+                maxDocId = std::max(maxDocId, m_docIds[m_postingOffsets[rank + 1] - 1]);
+        }
+        return maxDocId;
+    }
+
+    FrozenTermIndex FrozenTermIndex::merge(const FrozenTermIndex &first, const FrozenTermIndex &second)
+    {
+        always_assert((first.empty() || second.empty() || (first.m_dictionary == second.m_dictionary)) &&
+                      "Merged indices must share the term dictionary.");
+        FrozenTermIndex result;
+        result.m_dictionary = first.empty() ? second.m_dictionary : first.m_dictionary;
+        const bool positional = first.is_positional() || second.is_positional();
+        if (positional)
+        {
+            result.m_positionOffsets.push_back(0);
+        }
+
+        const auto append_posting = [&result, positional](const FrozenTermIndex &source, const size_t postingIndex)
+        {
+            result.m_docIds.push_back(source.m_docIds[postingIndex]);
+            result.m_frequencies.push_back(source.m_frequencies[postingIndex]);
+            if (!positional)
+                return;
+            if (source.is_positional())
+            {
+                result.m_positionData.insert(result.m_positionData.end(),
+                                             source.m_positionData.begin() + source.m_positionOffsets[postingIndex],
+                                             source.m_positionData.begin() + source.m_positionOffsets[postingIndex + 1]);
+            }
+            result.m_positionOffsets.push_back(result.m_positionData.size());
+        };
+
+        size_t i = 0;
+        size_t j = 0;
+        while ((i < first.size()) || (j < second.size()))
+        {
+            const bool takeFirst = (j == second.size()) || ((i < first.size()) && (first.get_term(i) <= second.get_term(j)));
+            const bool takeSecond = (i == first.size()) || ((j < second.size()) && (second.get_term(j) <= first.get_term(i)));
+
+            result.add_term(takeFirst ? first.get_term(i) : second.get_term(j),
+                            takeFirst ? first.get_term_id(i) : second.get_term_id(j));
+
+            // Postings of a term present in both indices are merged by document id.
+            size_t a = takeFirst ? first.m_postingOffsets[i] : 0;
+            const size_t aEnd = takeFirst ? first.m_postingOffsets[i + 1] : 0;
+            size_t b = takeSecond ? second.m_postingOffsets[j] : 0;
+            const size_t bEnd = takeSecond ? second.m_postingOffsets[j + 1] : 0;
+            while ((a < aEnd) || (b < bEnd))
+            {
+                if ((b == bEnd) || ((a < aEnd) && (first.m_docIds[a] < second.m_docIds[b])))
+                {
+                    append_posting(first, a++);
+                }
+                else
+                {
+                    if ((a < aEnd) && (first.m_docIds[a] == second.m_docIds[b]))
+                        ++a;
+                    append_posting(second, b++);
+                }
+            }
+            result.finish_term();
+
+            i += takeFirst ? 1 : 0;
+            j += takeSecond ? 1 : 0;
+        }
+        result.shrink_to_fit();
+        return result;
+    }
+
+    FrozenTermIndex FrozenTermIndex::concatenate(const std::vector<FrozenTermIndex> &parts)
+    {
+        FrozenTermIndex result;
+        bool positional = false;
+        size_t termCapacity = 0;
+        size_t postingCount = 0;
+        size_t positionBytes = 0;
+        for (const auto &part : parts)
+        {
+            if (part.empty())
+                continue;
+            always_assert(((result.m_dictionary == nullptr) || (result.m_dictionary == part.m_dictionary)) &&
+                          "Concatenated indices must share the term dictionary.");
+            result.m_dictionary = part.m_dictionary;
+            positional |= part.is_positional();
+            termCapacity = std::max(termCapacity, part.size());
+            postingCount += part.get_posting_count();
+            positionBytes += part.m_positionData.size();
+        }
+        if (positional)
+        {
+            result.m_positionOffsets.reserve(postingCount + 1);
+            result.m_positionOffsets.push_back(0);
+            result.m_positionData.reserve(positionBytes);
+        }
+        result.m_termIds.reserve(termCapacity);
+        result.m_docIds.reserve(postingCount);
+        result.m_frequencies.reserve(postingCount);
+
+        // Heap of the next term of every part, equal terms are popped in the order of the parts.
+        typedef std::pair<std::string_view, size_t> HeapEntry;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap;
+        std::vector<size_t> nextRank(parts.size(), 0);
+        for (size_t part = 0; part < parts.size(); ++part)
+        {
+            if (!parts[part].empty())
+                heap.emplace(parts[part].get_term(0), part);
+        }
+
+        while (!heap.empty())
+        {
+            const std::string_view term = heap.top().first;
+            const TermId termId = parts[heap.top().second].get_term_id(nextRank[heap.top().second]);
+            result.add_term(term, termId);
+
+            while (!heap.empty() && (heap.top().first == term))
+            {
+                const size_t part = heap.top().second;
+                heap.pop();
+                const FrozenTermIndex &source = parts[part];
+                const size_t rank = nextRank[part]++;
+                const size_t begin = source.m_postingOffsets[rank];
+                const size_t end = source.m_postingOffsets[rank + 1];
+
+                always_assert((result.m_docIds.size() == result.m_postingOffsets.back() ||
+                               result.m_docIds.back() < source.m_docIds[begin]) && "Parts have overlapping document ranges.");
+                result.m_docIds.insert(result.m_docIds.end(), source.m_docIds.begin() + begin, source.m_docIds.begin() + end);
+                result.m_frequencies.insert(result.m_frequencies.end(), source.m_frequencies.begin() + begin,
+                                            source.m_frequencies.begin() + end);
+                if (positional)
+                {
+                    for (size_t posting = begin; posting < end; ++posting)
+                    {
+                        if (source.is_positional())
+                        {
+                            result.m_positionData.insert(result.m_positionData.end(),
+                                                         source.m_positionData.begin() + source.m_positionOffsets[posting],
+                                                         source.m_positionData.begin() + source.m_positionOffsets[posting + 1]);
+                        }
+                        result.m_positionOffsets.push_back(result.m_positionData.size());
+                    }
+                }
+
+                if (nextRank[part] < source.size())
+                    heap.emplace(source.get_term(nextRank[part]), part);
+            }
+            result.finish_term();
+        }
+        result.shrink_to_fit();
+        return result;
+    }
+
+    size_t FrozenTermIndex::find(const std::string_view &term) const
+    {
+        return find_term_rank(term, size(), [this](const size_t rank)
+                              { return get_term(rank); });
+    }
+
+    std::string_view FrozenTermIndex::get_term(const size_t rank) const
+    {
+        return std::string_view(m_termData.data() + m_termOffsets[rank], m_termOffsets[rank + 1] - m_termOffsets[rank]);
+    }
+
+    PostingList FrozenTermIndex::get_postings(const size_t rank) const
+    {
+        const size_t begin = m_postingOffsets[rank];
+        return PostingList{m_docIds.data() + begin, m_frequencies.data() + begin, m_postingOffsets[rank + 1] - begin};
+    }
+
+    std::vector<azgra::u32> FrozenTermIndex::get_positions(const size_t rank, const size_t postingIndex) const
+    {
+        if (!is_positional())
+            return {};
+
+        const size_t posting = m_postingOffsets[rank] + postingIndex;
+        const azgra::byte *it = m_positionData.data() + m_positionOffsets[posting];
+        const azgra::byte *end = m_positionData.data() + m_positionOffsets[posting + 1];
+        std::vector<azgra::u32> positions;
+        azgra::u32 previous = 0;
+        while (it < end)
+        {
+            previous += read_varint(it);
+            positions.push_back(previous);
+        }
+        return positions;
+    }
+
+    size_t FrozenTermIndex::get_memory_bytes() const
+    {
+        return m_termData.capacity() +
+               (m_termOffsets.capacity() * sizeof(azgra::u32)) +
+               (m_termIds.capacity() * sizeof(TermId)) +
+               (m_postingOffsets.capacity() * sizeof(azgra::u64)) +
+               (m_docIds.capacity() * sizeof(azgra::u32)) +
+               (m_frequencies.capacity() * sizeof(azgra::u32));
+    }
+
+    size_t FrozenTermIndex::get_position_bytes() const
+    {
+        return (m_positionOffsets.capacity() * sizeof(azgra::u64)) + m_positionData.capacity();
+    }
+}
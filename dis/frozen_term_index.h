@@ -0,0 +1,113 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <azgra/azgra.h>
+#include "term_index.h"
+#include "term_rank.h"
+
+namespace dis
+{
+    /// Postings of one term, views into the arrays of FrozenTermIndex.
+    struct PostingList
+    {
+        const azgra::u32 *docIds = nullptr;
+        const azgra::u32 *frequencies = nullptr;
+        size_t size = 0;
+
+        bool operator<(const PostingList &other) const
+        {
+            return (size < other.size);
+        }
+    };
+
+    /// Read-only inverted index in compressed sparse row layout. Terms are sorted, postings of all terms lie in one array of
+    /// document ids with a parallel array of term frequencies, every term has its offset into them. Terms are addressed by
+    /// their rank in the sorted term table.
+    class FrozenTermIndex
+    {
+    private:
+        std::shared_ptr<TermDictionary> m_dictionary;
+        std::string m_termData;
+        std::vector<azgra::u32> m_termOffsets;
+        std::vector<TermId> m_termIds;
+        std::vector<azgra::u64> m_postingOffsets;
+        std::vector<azgra::u32> m_docIds;
+        std::vector<azgra::u32> m_frequencies;
+        /// Offsets of the encoded positions of every posting, empty if the index isn't positional.
+        std::vector<azgra::u64> m_positionOffsets;
+        std::vector<azgra::byte> m_positionData;
+
+        void add_term(const std::string_view &term, const TermId termId);
+
+        void finish_term();
+
+        void shrink_to_fit();
+
+    public:
+        static constexpr size_t NotFound = TermNotFound;
+
+        FrozenTermIndex();
+
+        /// Freeze postings of the mutable index, positions are included if the index is positional.
+        explicit FrozenTermIndex(const TermIndex &index);
+
+        /// Empty index filled by append_term, terms are interned in the dictionary.
+        explicit FrozenTermIndex(std::shared_ptr<TermDictionary> dictionary);
+
+        /// Append the term with its postings, terms must be appended in ascending order.
+        void append_term(const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies, const size_t count);
+
+        /// Release the spare capacity after the last appended term.
+        void finish_appending()
+        { shrink_to_fit(); }
+
+        /// Create index with the postings of both indices, which must share the term dictionary.
+        static FrozenTermIndex merge(const FrozenTermIndex &first, const FrozenTermIndex &second);
+
+        /// K-way merge of partial indices sharing the term dictionary. Every part must contain only documents with greater
+        /// ids than the previous parts, so postings of a term are simply concatenated in the order of the parts.
+        static FrozenTermIndex concatenate(const std::vector<FrozenTermIndex> &parts);
+
+        /// Find rank of the term by binary search in the term table.
+        /// \return Rank of the term or NotFound.
+        [[nodiscard]] size_t find(const std::string_view &term) const;
+
+        [[nodiscard]] std::string_view get_term(const size_t rank) const;
+
+        /// Get TermId of the term in the shared dictionary.
+        [[nodiscard]] TermId get_term_id(const size_t rank) const
+        { return m_termIds[rank]; }
+
+        [[nodiscard]] PostingList get_postings(const size_t rank) const;
+
+        /// Get decoded positions of the posting with the index relative to the term postings.
+        [[nodiscard]] std::vector<azgra::u32> get_positions(const size_t rank, const size_t postingIndex) const;
+
+        [[nodiscard]] bool is_positional() const
+        { return !m_positionOffsets.empty(); }
+
+        [[nodiscard]] const std::shared_ptr<TermDictionary> &get_shared_dictionary() const
+        { return m_dictionary; }
+
+        /// Number of terms.
+        [[nodiscard]] size_t size() const
+        { return m_termIds.size(); }
+
+        [[nodiscard]] bool empty() const
+        { return m_termIds.empty(); }
+
+        [[nodiscard]] size_t get_posting_count() const
+        { return m_docIds.size(); }
+
+        /// Largest document id of all postings, zero if the index is empty.
+        [[nodiscard]] DocId get_max_doc_id() const;
+
+        /// Memory used by the term table and the posting arrays, positions are in get_position_bytes.
+        [[nodiscard]] size_t get_memory_bytes() const;
+
+        [[nodiscard]] size_t get_position_bytes() const;
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    /// 64-bit FNV-1a hash of the bytes.
+    inline azgra::u64 fnv1a_hash(const char *data, const size_t length)
+    {
+        azgra::u64 hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<azgra::byte>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /// Smallest power of two which is greater or equal to the value.
+    inline size_t next_power_of_two(const size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,389 @@
+#include "inplace_stemmer.h"
+#include <cstring>
+#include <string>
+#include "porter_stemmer.h"
+
+namespace dis
+{
+    /// Word being stemmed. Indices have the meaning of StemInfo, buffer keeps the original length, so the characters
+    /// behind the end are still visible the same way they are to AsciiString::last_index_of.
+    struct InPlaceWord
+    {
+        char *b;
+        long length;
+        long end;
+        long offset;
+    };
+
+    /// Check if the word ends with the suffix. Like the AsciiString version, the check fails if the suffix also occurs later
+    /// in the whole buffer. If true set the offset to the index before suffix.
+    template<size_t N>
+    static inline bool ends(InPlaceWord &w, const char (&suffix)[N])
+    {
+        constexpr long suffixLength = N - 1;
+        if (suffixLength > (w.end + 1))
+            return false;
+
+        const long start = w.end - suffixLength + 1;
+        if (memcmp(w.b + start, suffix, suffixLength) != 0)
+            return false;
+        for (long later = start + 1; later <= (w.length - suffixLength); ++later)
+        {
+            if (memcmp(w.b + later, suffix, suffixLength) == 0)
+                return false;
+        }
+        w.offset = w.end - suffixLength;
+        return true;
+    }
+
+    template<size_t N>
+    static inline void set_end(InPlaceWord &w, const char (&suffix)[N])
+    {
+        constexpr long suffixLength = N - 1;
+        memcpy(w.b + w.offset + 1, suffix, suffixLength);
+        w.end = w.offset + suffixLength;
+    }
+
+    static inline bool is_consonant(const InPlaceWord &w, const long i)
+    {
+        switch (w.b[i])
+        {
+            case 'a':
+            case 'e':
+            case 'i':
+            case 'o':
+            case 'u':
+                return false;
+            case 'y':
+                return (i == 0) || !is_consonant(w, i - 1);
+            default:
+                return true;
+        }
+    }
+
+    static size_t vc_seq_count(const InPlaceWord &w)
+    {
+        if (w.offset < 0 || w.offset > w.end)
+            return 0;
+        size_t result = 0;
+        long i = 0;
+        for (;;)
+        {
+            if (i > w.offset)
+                return result;
+            if (!is_consonant(w, i))
+                break;
+            ++i;
+        }
+        ++i;
+        for (;;)
+        {
+            for (;;)
+            {
+                if (i > w.offset)
+                    return result;
+                if (is_consonant(w, i))
+                    break;
+                ++i;
+            }
+            ++i;
+            ++result;
+            for (;;)
+            {
+                if (i > w.offset)
+                    return result;
+                if (!is_consonant(w, i))
+                    break;
+                ++i;
+            }
+            ++i;
+        }
+    }
+
+    static bool vowel_in_stem(const InPlaceWord &w)
+    {
+        for (long i = 0; i < (w.offset + 1); ++i)
+        {
+            if (!is_consonant(w, i))
+                return true;
+        }
+        return false;
+    }
+
+    static bool double_consonant(const InPlaceWord &w, const long i)
+    {
+        if (i < 1 || w.b[i] != w.b[i - 1])
+            return false;
+        return is_consonant(w, i);
+    }
+
+    static bool is_cvc_end(const InPlaceWord &w, const long i)
+    {
+        if ((i < 2) || !is_consonant(w, i - 2) || is_consonant(w, i - 1) || !is_consonant(w, i))
+            return false;
+        const char c = w.b[i];
+        return !(c == 'w' || c == 'x' || c == 'y');
+    }
+
+    template<size_t N>
+    static inline void replace_end_if_m_gt0(InPlaceWord &w, const char (&suffix)[N])
+    {
+        if (vc_seq_count(w) > 0)
+            set_end(w, suffix);
+    }
+
+    static void step_1abc(InPlaceWord &w)
+    {
+        if (w.b[w.end] == 's' && ends(w, "s"))
+        {
+            if (ends(w, "sses"))
+                w.end -= 2;
+            else if (ends(w, "ies"))
+                set_end(w, "i");
+            else if (w.b[w.end - 1] != 's')
+                w.end -= 1;
+        }
+
+        const char last = w.b[w.end];
+        if (last == 'd' && ends(w, "eed"))
+        {
+            if (vc_seq_count(w) > 0)
+                w.end -= 1;
+        }
+        else if (((last == 'd' && ends(w, "ed")) || (last == 'g' && ends(w, "ing"))) && vowel_in_stem(w))
+        {
+            w.end = w.offset;
+            if (ends(w, "at"))
+                set_end(w, "ate");
+            else if (ends(w, "bl"))
+                set_end(w, "ble");
+            else if (ends(w, "iz"))
+                set_end(w, "ize");
+            else if (double_consonant(w, w.end))
+            {
+                --w.end;
+                const char c = w.b[w.end];
+                if (c == 'l' || c == 's' || c == 'z')
+                    ++w.end;
+            }
+            else if ((vc_seq_count(w) == 1) && is_cvc_end(w, w.end))
+                set_end(w, "e");
+        }
+
+        if (w.b[w.end] == 'y' && ends(w, "y") && vowel_in_stem(w))
+            set_end(w, "i");
+    }
+
+    static void step_2(InPlaceWord &w)
+    {
+        switch (w.b[w.end])
+        {
+            case 'l':
+                if (ends(w, "ational"))
+                    replace_end_if_m_gt0(w, "ate");
+                else if (ends(w, "tional"))
+                    replace_end_if_m_gt0(w, "tion");
+                break;
+            case 'i':
+                if (ends(w, "enci"))
+                    replace_end_if_m_gt0(w, "ence");
+                else if (ends(w, "anci"))
+                    replace_end_if_m_gt0(w, "ance");
+                else if (ends(w, "abli"))
+                    replace_end_if_m_gt0(w, "able");
+                else if (ends(w, "alli"))
+                    replace_end_if_m_gt0(w, "al");
+                else if (ends(w, "entli"))
+                    replace_end_if_m_gt0(w, "ent");
+                else if (ends(w, "eli"))
+                    replace_end_if_m_gt0(w, "e");
+                else if (ends(w, "ousli"))
+                    replace_end_if_m_gt0(w, "ous");
+                else if (ends(w, "aliti"))
+                    replace_end_if_m_gt0(w, "al");
+                else if (ends(w, "iviti"))
+                    replace_end_if_m_gt0(w, "ive");
+                else if (ends(w, "biliti"))
+                    replace_end_if_m_gt0(w, "ble");
+                break;
+            case 'r':
+                if (ends(w, "izer"))
+                    replace_end_if_m_gt0(w, "ize");
+                else if (ends(w, "ator"))
+                    replace_end_if_m_gt0(w, "ate");
+                break;
+            case 'n':
+                if (ends(w, "ization"))
+                    replace_end_if_m_gt0(w, "ize");
+                else if (ends(w, "ation"))
+                    replace_end_if_m_gt0(w, "ate");
+                break;
+            case 'm':
+                if (ends(w, "alism"))
+                    replace_end_if_m_gt0(w, "al");
+                break;
+            case 's':
+                if (ends(w, "iveness"))
+                    replace_end_if_m_gt0(w, "ive");
+                else if (ends(w, "fulness"))
+                    replace_end_if_m_gt0(w, "ful");
+                else if (ends(w, "ousness"))
+                    replace_end_if_m_gt0(w, "ous");
+                break;
+            default:
+                break;
+        }
+    }
+
+    static void step_3(InPlaceWord &w)
+    {
+        switch (w.b[w.end])
+        {
+            case 'e':
+                if (ends(w, "icate"))
+                    replace_end_if_m_gt0(w, "ic");
+                else if (ends(w, "ative"))
+                    replace_end_if_m_gt0(w, "");
+                else if (ends(w, "alize"))
+                    replace_end_if_m_gt0(w, "al");
+                break;
+            case 'i':
+                if (ends(w, "iciti"))
+                    replace_end_if_m_gt0(w, "ic");
+                break;
+            case 'l':
+                if (ends(w, "ical"))
+                    replace_end_if_m_gt0(w, "ic");
+                else if (ends(w, "ful"))
+                    replace_end_if_m_gt0(w, "");
+                break;
+            case 's':
+                if (ends(w, "ness"))
+                    replace_end_if_m_gt0(w, "");
+                break;
+            default:
+                break;
+        }
+    }
+
+    static void step_4(InPlaceWord &w)
+    {
+        // Dispatch on the second last character. Any other character falls through to the measure test with the last
+        // offset, just like the original implementation.
+        bool matched = true;
+        switch ((w.end > 0) ? w.b[w.end - 1] : '\0')
+        {
+            case 'a':
+                matched = ends(w, "al");
+                break;
+            case 'c':
+                matched = ends(w, "ence") || ends(w, "ance");
+                break;
+            case 'e':
+                matched = ends(w, "er");
+                break;
+            case 'i':
+                matched = ends(w, "ic");
+                break;
+            case 'l':
+                matched = ends(w, "able") || ends(w, "ible");
+                break;
+            case 'n':
+                matched = ends(w, "ant") || ends(w, "ement") || ends(w, "ment") || ends(w, "end");
+                break;
+            case 'o':
+                matched = (ends(w, "ion") && ((w.b[w.offset] == 's') || (w.b[w.offset] == 't'))) || ends(w, "ou");
+                break;
+            case 's':
+                matched = ends(w, "ism");
+                break;
+            case 't':
+                matched = ends(w, "ate") || ends(w, "iti");
+                break;
+            case 'u':
+                matched = ends(w, "ous");
+                break;
+            case 'v':
+                matched = ends(w, "ive");
+                break;
+            case 'z':
+                matched = ends(w, "ize");
+                break;
+            default:
+                break;
+        }
+        if (matched && (vc_seq_count(w) > 1))
+            w.end = w.offset;
+    }
+
+    static void step_5(InPlaceWord &w)
+    {
+        w.offset = w.end;
+        if (w.b[w.end] == 'e')
+        {
+            const size_t m = vc_seq_count(w);
+            if ((m > 1) || ((m == 1) && (!is_cvc_end(w, w.end - 1))))
+                --w.end;
+        }
+        if (w.b[w.end] == 'l')
+        {
+            if (double_consonant(w, w.end) && vc_seq_count(w) > 1)
+                --w.end;
+        }
+    }
+
+    size_t stem_in_place(char *word, const size_t length)
+    {
+        // NOTE(Moravec): No change can be made to strings of size [0,2]
+        if (length < 3)
+            return length;
+
+        InPlaceWord w = {word, static_cast<long>(length), static_cast<long>(length) - 1, 0};
+        step_1abc(w);
+        step_2(w);
+        step_3(w);
+        step_4(w);
+        step_5(w);
+        return static_cast<size_t>(w.end + 1);
+    }
+
+    void stem_batch(StemSpan *spans, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            spans[i].length = stem_in_place(spans[i].data, spans[i].length);
+        }
+    }
+
+    void test_inplace_stemmer()
+    {
+        const char *words[] = {"caresses", "ponies", "ties", "caress", "cats", "feed", "agreed", "plastered", "bled", "motoring",
+                               "sing", "conflated", "troubling", "sized", "hopping", "tanned", "hissing", "fizzed", "happy", "sky",
+                               "relational", "conditional", "rational", "valenci", "hesitanci", "digitizer", "radicalli",
+                               "vileli", "analogousli", "operator", "decisiveness", "hopefulness", "callousness", "formaliti",
+                               "sensitiviti", "vietnamization", "triplicate", "formative", "formalize", "electriciti",
+                               "electrical", "hopeful", "goodness", "revival", "allowance", "inference", "airliner",
+                               "gyroscopic", "adjustable", "defensible", "irritant", "replacement", "adjustment", "dependant",
+                               "adoption", "adopsion", "homologou", "communism", "activate", "angulariti", "homologous",
+                               "effective", "bowdlerize", "probate", "rate", "cease", "controll", "roll", "warcraft"};
+
+        size_t failed = 0;
+        for (const char *word : words)
+        {
+            std::string buffer(word);
+            buffer.resize(stem_in_place(buffer.data(), buffer.length()));
+            const AsciiString expected = stem_word(word);
+            if (!expected.equals(buffer.c_str()))
+            {
+                ++failed;
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "In place stem of %s is %s, stem_word gives %s\n",
+                                       word, buffer.c_str(), expected.get_c_string());
+            }
+        }
+        if (failed == 0)
+        {
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "In place stemmer matches stem_word on %lu words\n",
+                                   sizeof(words) / sizeof(words[0]));
+        }
+    }
+}
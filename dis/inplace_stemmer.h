@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dis
+{
+    /// Word buffer given to the stemmer.
+    struct StemSpan
+    {
+        char *data = nullptr;
+        size_t length = 0;
+    };
+
+    /// Stem the word in its own buffer. Stem is always a prefix of the buffer and nothing is allocated. Results are the same
+    /// as of stem_word from porter_stemmer.h.
+    /// \param word Word buffer, modified in place.
+    /// \param length Length of the word.
+    /// \return Length of the stem.
+    size_t stem_in_place(char *word, const size_t length);
+
+    /// Stem all the words in place, length of every span is set to the length of its stem.
+    /// \param spans Word spans.
+    /// \param count Number of spans.
+    void stem_batch(StemSpan *spans, const size_t count);
+
+    /// Compare the in place stemmer with stem_word on the Porter test vectors.
+    void test_inplace_stemmer();
+}
@@ -0,0 +1,142 @@
+#include "lazy_compressed_index.h"
+#include "codec_index.h"
+#include "sharded_index.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+
+namespace dis
+{
+    static bool is_codec_index_data(const char *data, const size_t size)
+    {
+        return (size >= sizeof(CodecIndexHeader)) && (memcmp(data, CodecIndexMagic, sizeof(CodecIndexMagic)) == 0);
+    }
+
+    static bool is_sharded_index_data(const char *data, const size_t size)
+    {
+        return (size >= sizeof(ShardedIndexHeader)) && (memcmp(data, ShardedIndexMagic, sizeof(ShardedIndexMagic)) == 0);
+    }
+
+    LazyCompressedIndex::LazyCompressedIndex(const char *path, const size_t cacheCapacity) :
+            m_file(path), m_cacheCapacity(cacheCapacity)
+    {
+        always_assert(read_term_directory(m_file.data(), m_file.size(), m_directory) && "Compressed index has no term directory.");
+
+        if (is_codec_index_data(m_file.data(), m_file.size()))
+        {
+            const auto *header = reinterpret_cast<const CodecIndexHeader *>(m_file.data());
+            always_assert(header->version == CodecIndexVersion && "Unsupported compressed index version.");
+            always_assert(header->termCount == m_directory.size() && "Term directory doesn't match the index.");
+            m_codec = create_postings_codec(header->codec);
+        }
+        else if (is_sharded_index_data(m_file.data(), m_file.size()))
+        {
+            const auto *header = reinterpret_cast<const ShardedIndexHeader *>(m_file.data());
+            always_assert(header->version == ShardedIndexVersion && "Unsupported sharded index version.");
+            always_assert(header->termCount == m_directory.size() && "Term directory doesn't match the index.");
+            m_codec = create_postings_codec(header->codec);
+        }
+        else
+        {
+            const BitStreamLayout *layout = get_bit_stream_layout();
+            always_assert(layout != nullptr && "Fibonacci index can't be decoded without the bit stream layout.");
+            m_layout = *layout;
+        }
+
+        for (const TermDirectoryEntry &entry : m_directory)
+        {
+            m_postingCount += entry.postingCount;
+        }
+        // Queries touch only the postings of their terms, read ahead would only waste the page cache.
+        madvise(const_cast<char *>(m_file.data()), m_file.size(), MADV_RANDOM);
+    }
+
+    bool LazyCompressedIndex::can_open(const char *path)
+    {
+        if (!has_term_directory(path))
+            return false;
+        return is_codec_index(path) || is_sharded_index(path) || (get_bit_stream_layout() != nullptr);
+    }
+
+    size_t LazyCompressedIndex::find(const std::string_view &term) const
+    {
+        return find_term_rank(term, m_directory.size(), [this](const size_t rank)
+                              { return m_directory[rank].term; });
+    }
+
+    void LazyCompressedIndex::decode_postings(const size_t rank, std::vector<azgra::u32> &docIds) const
+    {
+        const TermDirectoryEntry &entry = m_directory[rank];
+        docIds.resize(entry.postingCount);
+        if (m_codec != nullptr)
+        {
+            // The directory and its footer after the last term cover the decoder padding.
+            const auto *data = reinterpret_cast<const azgra::byte *>(m_file.data()) + entry.postingsOffset;
+            m_codec->decode(data, entry.postingCount, docIds.data());
+            for (size_t i = 1; i < docIds.size(); ++i)
+            {
+                docIds[i] += docIds[i - 1];
+            }
+            return;
+        }
+
+        BitReader reader(reinterpret_cast<const azgra::byte *>(m_file.data()), m_file.size(), m_layout);
+        reader.skip(entry.postingsOffset);
+        azgra::u32 docId = 0;
+        for (auto &id : docIds)
+        {
+            int codeLength;
+            docId += fibonacci_decode(reader.peek(), codeLength);
+            reader.skip(codeLength);
+            id = docId;
+        }
+    }
+
+    LazyCompressedIndex::DocIds LazyCompressedIndex::get_doc_ids(const size_t rank) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_cacheLock);
+            const auto it = m_cache.find(rank);
+            if (it != m_cache.end())
+            {
+                ++m_hits;
+                m_recency.splice(m_recency.begin(), m_recency, it->second.recency);
+                return it->second.docIds;
+            }
+            ++m_misses;
+        }
+
+        // Decoded outside of the lock, concurrent misses of the same term only decode it twice.
+        auto docIds = std::make_shared<std::vector<azgra::u32>>();
+        decode_postings(rank, *docIds);
+        const size_t bytes = docIds->size() * sizeof(azgra::u32);
+
+        std::lock_guard<std::mutex> lock(m_cacheLock);
+        if (m_cache.find(rank) == m_cache.end())
+        {
+            m_recency.push_front(rank);
+            m_cache.emplace(rank, CacheEntry{docIds, m_recency.begin()});
+            m_cachedBytes += bytes;
+            // The list just decoded is kept even if it alone exceeds the capacity.
+            while ((m_cachedBytes > m_cacheCapacity) && (m_recency.size() > 1))
+            {
+                const auto evicted = m_cache.find(m_recency.back());
+                m_cachedBytes -= evicted->second.docIds->size() * sizeof(azgra::u32);
+                m_cache.erase(evicted);
+                m_recency.pop_back();
+            }
+        }
+        return docIds;
+    }
+
+    PostingCacheStatistics LazyCompressedIndex::get_cache_statistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_cacheLock);
+        PostingCacheStatistics statistics = {};
+        statistics.hits = m_hits;
+        statistics.misses = m_misses;
+        statistics.entries = m_cache.size();
+        statistics.bytes = m_cachedBytes;
+        return statistics;
+    }
+}
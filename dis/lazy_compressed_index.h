@@ -0,0 +1,105 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "fibonacci_coding.h"
+#include "memory_mapped_file.h"
+#include "postings_codec.h"
+#include "term_directory.h"
+#include "term_rank.h"
+
+namespace dis
+{
+    struct PostingCacheStatistics
+    {
+        azgra::u64 hits = 0;
+        azgra::u64 misses = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+
+        [[nodiscard]] double hit_rate() const
+        {
+            const azgra::u64 lookups = hits + misses;
+            return (lookups == 0) ? 0.0 : (static_cast<double>(hits) / static_cast<double>(lookups));
+        }
+    };
+
+    /// Compressed index opened from its memory mapping, only the term directory is read when it is opened. Posting lists
+    /// are decoded when a query first asks for them and kept in the least recently used cache of bounded size.
+    class LazyCompressedIndex
+    {
+    public:
+        /// Decoded document ids, shared with the cache so the evicted lists stay valid while they are used.
+        using DocIds = std::shared_ptr<const std::vector<azgra::u32>>;
+
+        static constexpr size_t NotFound = TermNotFound;
+        static constexpr size_t DefaultCacheCapacity = 64 * 1024 * 1024;
+
+    private:
+        struct CacheEntry
+        {
+            DocIds docIds;
+            std::list<size_t>::iterator recency;
+        };
+
+        MemoryMappedFile m_file;
+        std::vector<TermDirectoryEntry> m_directory;
+        /// Codec of the codec index, Fibonacci index is decoded with the bit stream layout instead.
+        std::unique_ptr<PostingsCodec> m_codec;
+        BitStreamLayout m_layout;
+        size_t m_postingCount = 0;
+
+        size_t m_cacheCapacity;
+        mutable std::mutex m_cacheLock;
+        mutable std::unordered_map<size_t, CacheEntry> m_cache;
+        /// Ranks of the cached lists, the most recently used first.
+        mutable std::list<size_t> m_recency;
+        mutable size_t m_cachedBytes = 0;
+        mutable azgra::u64 m_hits = 0;
+        mutable azgra::u64 m_misses = 0;
+
+    public:
+        /// Open the compressed index written by dump_compressed_index.
+        /// \param path Index file with the term directory.
+        /// \param cacheCapacity Upper bound of the bytes of the cached document ids.
+        explicit LazyCompressedIndex(const char *path, const size_t cacheCapacity = DefaultCacheCapacity);
+
+        LazyCompressedIndex(const LazyCompressedIndex &) = delete;
+
+        LazyCompressedIndex &operator=(const LazyCompressedIndex &) = delete;
+
+        /// Check whether the file can be opened lazily, it needs the term directory and a known bit layout.
+        static bool can_open(const char *path);
+
+        /// Find rank of the term by binary search in the directory.
+        /// \return Rank of the term or NotFound.
+        [[nodiscard]] size_t find(const std::string_view &term) const;
+
+        [[nodiscard]] std::string_view get_term(const size_t rank) const
+        { return m_directory[rank].term; }
+
+        [[nodiscard]] size_t get_posting_count(const size_t rank) const
+        { return m_directory[rank].postingCount; }
+
+        /// Get document ids of the term, they are decoded on the first access.
+        [[nodiscard]] DocIds get_doc_ids(const size_t rank) const;
+
+        /// Decode document ids of the term without caching them.
+        void decode_postings(const size_t rank, std::vector<azgra::u32> &docIds) const;
+
+        [[nodiscard]] PostingCacheStatistics get_cache_statistics() const;
+
+        [[nodiscard]] size_t size() const
+        { return m_directory.size(); }
+
+        [[nodiscard]] bool empty() const
+        { return m_directory.empty(); }
+
+        [[nodiscard]] size_t get_posting_count() const
+        { return m_postingCount; }
+    };
+}
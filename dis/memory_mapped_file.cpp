@@ -0,0 +1,63 @@
+#include "memory_mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dis
+{
+    MemoryMappedFile::MemoryMappedFile(const char *fileName)
+    {
+        const int fd = open(fileName, O_RDONLY);
+        always_assert(fd != -1 && "Failed to open file for memory mapping.");
+
+        struct stat fileStat = {};
+        always_assert(fstat(fd, &fileStat) == 0);
+        m_size = static_cast<size_t>(fileStat.st_size);
+
+        if (m_size > 0)
+        {
+            void *mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            always_assert(mapping != MAP_FAILED && "Failed to memory map file.");
+            madvise(mapping, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char *>(mapping);
+        }
+        close(fd);
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        unmap();
+    }
+
+    MemoryMappedFile::MemoryMappedFile(MemoryMappedFile &&other) noexcept
+    {
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    MemoryMappedFile &MemoryMappedFile::operator=(MemoryMappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    void MemoryMappedFile::unmap()
+    {
+        if (m_data != nullptr)
+        {
+            munmap(const_cast<char *>(m_data), m_size);
+            m_data = nullptr;
+            m_size = 0;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    /// Read-only memory mapping of the whole file. The mapping is released when the object is destroyed or unmapped.
+    class MemoryMappedFile
+    {
+    private:
+        const char *m_data = nullptr;
+        size_t m_size = 0;
+
+    public:
+        MemoryMappedFile() = default;
+
+        explicit MemoryMappedFile(const char *fileName);
+
+        ~MemoryMappedFile();
+
+        MemoryMappedFile(const MemoryMappedFile &) = delete;
+
+        MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+
+        MemoryMappedFile(MemoryMappedFile &&other) noexcept;
+
+        MemoryMappedFile &operator=(MemoryMappedFile &&other) noexcept;
+
+        void unmap();
+
+        [[nodiscard]] const char *data() const
+        { return m_data; }
+
+        [[nodiscard]] size_t size() const
+        { return m_size; }
+
+        [[nodiscard]] bool is_mapped() const
+        { return (m_data != nullptr); }
+    };
+}
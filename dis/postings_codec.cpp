@@ -0,0 +1,312 @@
+#include "postings_codec.h"
+#include "fibonacci_coding.h"
+#include "varint.h"
+#include <array>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DIS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace dis
+{
+    void FibonacciCodec::encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const
+    {
+        BitWriter writer;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const FibonacciCode code = fibonacci_encode(values[i]);
+            writer.write_bits(code.bits, code.length);
+        }
+        const auto bytes = writer.finish();
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    const azgra::byte *FibonacciCodec::decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const
+    {
+        // Input is padded, the reader may load whole words past the last code.
+        BitReader reader(data, std::numeric_limits<size_t>::max() - sizeof(azgra::u64));
+        for (size_t i = 0; i < count; ++i)
+        {
+            int codeLength;
+            values[i] = fibonacci_decode(reader.peek(), codeLength);
+            reader.skip(codeLength);
+        }
+        return data + reader.get_byte_position();
+    }
+
+    void VByteCodec::encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            write_varint(buffer, values[i]);
+        }
+    }
+
+    const azgra::byte *VByteCodec::decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = read_varint(data);
+        }
+        return data;
+    }
+
+    /// Byte lengths of four values of every Stream VByte control byte and the shuffles moving them to 32 bit lanes.
+    struct StreamVByteTable
+    {
+        azgra::byte lengths[256]{};
+        alignas(16) azgra::byte shuffle[256][16]{};
+
+        constexpr StreamVByteTable()
+        {
+            for (int control = 0; control < 256; ++control)
+            {
+                azgra::byte offset = 0;
+                for (int value = 0; value < 4; ++value)
+                {
+                    const int length = ((control >> (2 * value)) & 3) + 1;
+                    for (int byte = 0; byte < 4; ++byte)
+                        shuffle[control][(4 * value) + byte] = (byte < length) ? static_cast<azgra::byte>(offset + byte) : 0x80;
+                    offset += length;
+                }
+                lengths[control] = offset;
+            }
+        }
+    };
+
+    static constexpr StreamVByteTable StreamVByte = {};
+
+    void StreamVByteCodec::encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const
+    {
+        const size_t controlOffset = buffer.size();
+        buffer.resize(buffer.size() + ((count + 3) / 4), 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const azgra::u32 value = values[i];
+            const int length = (value < (1u << 8)) ? 1 : (value < (1u << 16)) ? 2 : (value < (1u << 24)) ? 3 : 4;
+            buffer[controlOffset + (i / 4)] |= static_cast<azgra::byte>((length - 1) << (2 * (i % 4)));
+            for (int byte = 0; byte < length; ++byte)
+                buffer.push_back(static_cast<azgra::byte>(value >> (8 * byte)));
+        }
+    }
+
+    static const azgra::byte *stream_vbyte_decode_scalar(const azgra::byte *control, const azgra::byte *data, const size_t first,
+                                                         const size_t count, azgra::u32 *values)
+    {
+        for (size_t i = first; i < count; ++i)
+        {
+            const int length = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+            azgra::u32 value = 0;
+            for (int byte = 0; byte < length; ++byte)
+                value |= static_cast<azgra::u32>(data[byte]) << (8 * byte);
+            values[i] = value;
+            data += length;
+        }
+        return data;
+    }
+
+#if DIS_X86_SIMD
+
+    __attribute__((target("ssse3")))
+    static const azgra::byte *stream_vbyte_decode_ssse3(const azgra::byte *control, const azgra::byte *data, const size_t count,
+                                                        azgra::u32 *values)
+    {
+        const size_t groupCount = count / 4;
+        for (size_t group = 0; group < groupCount; ++group)
+        {
+            const azgra::byte controlByte = control[group];
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(StreamVByte.shuffle[controlByte]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(values + (4 * group)), _mm_shuffle_epi8(bytes, mask));
+            data += StreamVByte.lengths[controlByte];
+        }
+        return stream_vbyte_decode_scalar(control, data, groupCount * 4, count, values);
+    }
+
+#endif
+
+    const azgra::byte *StreamVByteCodec::decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const
+    {
+        const azgra::byte *control = data;
+        data += (count + 3) / 4;
+#if DIS_X86_SIMD
+        static const bool hasSsse3 = __builtin_cpu_supports("ssse3");
+        if (hasSsse3)
+            return stream_vbyte_decode_ssse3(control, data, count, values);
+#endif
+        return stream_vbyte_decode_scalar(control, data, 0, count, values);
+    }
+
+    static int bit_width(const azgra::u32 value)
+    {
+        return (value == 0) ? 0 : (32 - __builtin_clz(value));
+    }
+
+    /// Select the bit width of the block with the smallest size including the exceptions.
+    static int select_pfor_bit_width(const azgra::u32 *values)
+    {
+        std::array<size_t, 33> widthCounts = {};
+        for (size_t i = 0; i < PForCodec::BlockSize; ++i)
+            ++widthCounts[bit_width(values[i])];
+
+        int bestWidth = 32;
+        size_t bestSize = PForCodec::BlockSize * 4;
+        size_t exceptionCount = 0;
+        for (int width = 32; width >= 0; --width)
+        {
+            // Exception is its position byte and the high bits, at most five variable bytes.
+            const size_t size = ((PForCodec::BlockSize * width) / 8) + (exceptionCount * (1 + ((32 - width + 6) / 7)));
+            if (size < bestSize)
+            {
+                bestSize = size;
+                bestWidth = width;
+            }
+            exceptionCount += widthCounts[width];
+        }
+        return bestWidth;
+    }
+
+    void PForCodec::encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const
+    {
+        const size_t blockCount = count / BlockSize;
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            const azgra::u32 *blockValues = values + (block * BlockSize);
+            const int width = select_pfor_bit_width(blockValues);
+            const azgra::u64 mask = (1ull << width) - 1;
+
+            std::vector<azgra::byte> exceptions;
+            azgra::byte exceptionCount = 0;
+            for (size_t i = 0; i < BlockSize; ++i)
+            {
+                if ((static_cast<azgra::u64>(blockValues[i]) >> width) != 0)
+                {
+                    exceptions.push_back(static_cast<azgra::byte>(i));
+                    write_varint(exceptions, static_cast<azgra::u32>(static_cast<azgra::u64>(blockValues[i]) >> width));
+                    ++exceptionCount;
+                }
+            }
+
+            buffer.push_back(static_cast<azgra::byte>(width));
+            buffer.push_back(exceptionCount);
+            const size_t packedOffset = buffer.size();
+            buffer.resize(buffer.size() + ((BlockSize * width) / 8), 0);
+            for (size_t i = 0; i < BlockSize; ++i)
+            {
+                const size_t bitPosition = i * width;
+                const azgra::u64 bits = (blockValues[i] & mask) << (bitPosition % 8);
+                for (size_t byte = 0; (byte * 8) < ((bitPosition % 8) + width); ++byte)
+                    buffer[packedOffset + (bitPosition / 8) + byte] |= static_cast<azgra::byte>(bits >> (8 * byte));
+            }
+            buffer.insert(buffer.end(), exceptions.begin(), exceptions.end());
+        }
+        for (size_t i = blockCount * BlockSize; i < count; ++i)
+        {
+            write_varint(buffer, values[i]);
+        }
+    }
+
+    const azgra::byte *PForCodec::decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const
+    {
+        const size_t blockCount = count / BlockSize;
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            azgra::u32 *blockValues = values + (block * BlockSize);
+            const int width = data[0];
+            const size_t exceptionCount = data[1];
+            data += 2;
+
+            // Values are at most 32 bits wide and start within the first byte, one unaligned 8 byte load reads each of them.
+            const azgra::u64 mask = (1ull << width) - 1;
+            for (size_t i = 0; i < BlockSize; ++i)
+            {
+                const size_t bitPosition = i * width;
+                azgra::u64 word;
+                memcpy(&word, data + (bitPosition / 8), sizeof(word));
+                blockValues[i] = static_cast<azgra::u32>((word >> (bitPosition % 8)) & mask);
+            }
+            data += (BlockSize * width) / 8;
+
+            for (size_t exception = 0; exception < exceptionCount; ++exception)
+            {
+                const azgra::byte position = *data++;
+                const azgra::u32 highBits = read_varint(data);
+                blockValues[position] |= static_cast<azgra::u32>(static_cast<azgra::u64>(highBits) << width);
+            }
+        }
+        for (size_t i = blockCount * BlockSize; i < count; ++i)
+        {
+            values[i] = read_varint(data);
+        }
+        return data;
+    }
+
+    std::unique_ptr<PostingsCodec> create_postings_codec(const PostingsCodecType type)
+    {
+        switch (type)
+        {
+            case PostingsCodecType::Fibonacci:
+                return std::make_unique<FibonacciCodec>();
+            case PostingsCodecType::VByte:
+                return std::make_unique<VByteCodec>();
+            case PostingsCodecType::StreamVByte:
+                return std::make_unique<StreamVByteCodec>();
+            case PostingsCodecType::PFor:
+                return std::make_unique<PForCodec>();
+        }
+        always_assert(false && "Unknown postings codec.");
+        return nullptr;
+    }
+
+    void test_postings_codecs()
+    {
+        std::mt19937 generator(42);
+        std::vector<std::vector<azgra::u32>> lists;
+        for (const size_t count : {0, 1, 3, 4, 127, 128, 129, 1000, 5000})
+        {
+            std::vector<azgra::u32> values(count);
+            for (auto &value : values)
+            {
+                // Mostly small gaps with occasional large ones, like document id deltas of frequent terms.
+                const int width = ((generator() % 16) == 0) ? static_cast<int>(generator() % 32) + 1 : static_cast<int>(generator() % 8) + 1;
+                value = std::max<azgra::u32>(1, static_cast<azgra::u32>(generator() >> (32 - width)));
+            }
+            if (count > 1)
+                values[count / 2] = std::numeric_limits<azgra::u32>::max();
+            lists.push_back(std::move(values));
+        }
+
+        for (const PostingsCodecType type : {PostingsCodecType::Fibonacci, PostingsCodecType::VByte, PostingsCodecType::StreamVByte,
+                                             PostingsCodecType::PFor})
+        {
+            const auto codec = create_postings_codec(type);
+            std::vector<azgra::byte> buffer;
+            std::vector<size_t> listEnds;
+            for (const auto &values : lists)
+            {
+                codec->encode(values.data(), values.size(), buffer);
+                listEnds.push_back(buffer.size());
+            }
+            buffer.resize(buffer.size() + PostingsCodec::DecodePadding, 0);
+
+            size_t failed = 0;
+            const azgra::byte *data = buffer.data();
+            for (size_t list = 0; list < lists.size(); ++list)
+            {
+                std::vector<azgra::u32> decoded(lists[list].size());
+                data = codec->decode(data, decoded.size(), decoded.data());
+                if ((decoded != lists[list]) || (data != (buffer.data() + listEnds[list])))
+                    ++failed;
+            }
+            if (failed == 0)
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Codec %s round trip OK\n", codec->get_name());
+            else
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Codec %s failed on %lu lists\n", codec->get_name(),
+                                       failed);
+        }
+    }
+}
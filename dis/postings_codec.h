@@ -0,0 +1,112 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    enum class PostingsCodecType : azgra::u32
+    {
+        Fibonacci = 0,
+        VByte = 1,
+        StreamVByte = 2,
+        PFor = 3
+    };
+
+    /// Codec of positive integers, used for document id deltas of the compressed index.
+    class PostingsCodec
+    {
+    public:
+        /// Decoders may read this many bytes past the encoded values, the input buffer must be padded.
+        static constexpr size_t DecodePadding = 16;
+
+        virtual ~PostingsCodec() = default;
+
+        [[nodiscard]] virtual PostingsCodecType get_type() const = 0;
+
+        [[nodiscard]] virtual const char *get_name() const = 0;
+
+        /// Append the encoded values to the buffer.
+        /// \param values Values to encode.
+        /// \param count Number of values.
+        /// \param buffer Output buffer.
+        virtual void encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const = 0;
+
+        /// Decode count values.
+        /// \param data Encoded values, padded by DecodePadding bytes.
+        /// \param count Number of values.
+        /// \param values Output of count values.
+        /// \return Pointer past the encoded values.
+        virtual const azgra::byte *decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const = 0;
+    };
+
+    /// Zeckendorf representation of every value ending with 11, bits are packed from the least significant one. Every list
+    /// starts at byte boundary.
+    class FibonacciCodec : public PostingsCodec
+    {
+    public:
+        [[nodiscard]] PostingsCodecType get_type() const override
+        { return PostingsCodecType::Fibonacci; }
+
+        [[nodiscard]] const char *get_name() const override
+        { return "fibonacci"; }
+
+        void encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const override;
+
+        const azgra::byte *decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const override;
+    };
+
+    /// Seven bits per byte in the varint format of varint.h, the high bit is set on all but the last byte of the value.
+    class VByteCodec : public PostingsCodec
+    {
+    public:
+        [[nodiscard]] PostingsCodecType get_type() const override
+        { return PostingsCodecType::VByte; }
+
+        [[nodiscard]] const char *get_name() const override
+        { return "vbyte"; }
+
+        void encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const override;
+
+        const azgra::byte *decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const override;
+    };
+
+    /// Stream VByte, byte lengths of four values are stored in one control byte ahead of the value bytes. Groups of four
+    /// values are decoded by a single shuffle when SSSE3 is available.
+    class StreamVByteCodec : public PostingsCodec
+    {
+    public:
+        [[nodiscard]] PostingsCodecType get_type() const override
+        { return PostingsCodecType::StreamVByte; }
+
+        [[nodiscard]] const char *get_name() const override
+        { return "stream-vbyte"; }
+
+        void encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const override;
+
+        const azgra::byte *decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const override;
+    };
+
+    /// Patched frame of reference, blocks of 128 values are bit packed with the width fitting most of them, larger values
+    /// are patched from the exception list. The tail of the list is variable byte coded.
+    class PForCodec : public PostingsCodec
+    {
+    public:
+        static constexpr size_t BlockSize = 128;
+
+        [[nodiscard]] PostingsCodecType get_type() const override
+        { return PostingsCodecType::PFor; }
+
+        [[nodiscard]] const char *get_name() const override
+        { return "pfor"; }
+
+        void encode(const azgra::u32 *values, const size_t count, std::vector<azgra::byte> &buffer) const override;
+
+        const azgra::byte *decode(const azgra::byte *data, const size_t count, azgra::u32 *values) const override;
+    };
+
+    std::unique_ptr<PostingsCodec> create_postings_codec(const PostingsCodecType type);
+
+    void test_postings_codecs();
+}
@@ -0,0 +1,168 @@
+#include "sgml_article_reader.h"
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+namespace dis
+{
+    SgmlArticleReader::SgmlArticleReader(const char *fileName, const DocId firstDocId, const size_t memoryBudget)
+    {
+        m_fileName = fileName;
+        m_memoryBudget = memoryBudget;
+        m_nextDocId = firstDocId;
+        m_articleBuffer.reserve(memoryBudget);
+
+        m_stream = std::ifstream(fileName, std::ios::in);
+        always_assert(m_stream.is_open());
+        const std::string_view header = "<!DOCTYPE lewis SYSTEM \"lewis.dtd\">";
+        bool truncated;
+        always_assert(read_line(header.length(), truncated) && !truncated && (m_line == header) && "Wrong Sgml file header.");
+    }
+
+    bool SgmlArticleReader::read_line(const size_t maxLength, bool &truncated)
+    {
+        m_line.clear();
+        truncated = false;
+        bool readAny = false;
+        char chunk[4096];
+        while (true)
+        {
+            // get() stops before the new line character, so no more than one chunk is read past the maximal length.
+            m_stream.get(chunk, sizeof(chunk), '\n');
+            const auto count = static_cast<size_t>(m_stream.gcount());
+            if (count > 0)
+            {
+                readAny = true;
+                const size_t kept = std::min(count, maxLength - std::min(maxLength, m_line.length()));
+                m_line.append(chunk, kept);
+                truncated |= (kept < count);
+            }
+            if (m_stream.eof())
+                return readAny;
+            if (m_stream.fail())
+            {
+                // Nothing was extracted because the new line character follows immediately.
+                m_stream.clear();
+            }
+            if (m_stream.peek() == '\n')
+            {
+                m_stream.ignore();
+                return true;
+            }
+        }
+    }
+
+    bool SgmlArticleReader::read_next(ReutersArticle &article)
+    {
+        m_articleBuffer.clear();
+        m_lineRanges.clear();
+        bool insideArticle = false;
+        bool overBudget = false;
+        bool truncated;
+
+        // Lines are read up to the rest of the budget, but never shorter than the longest tag, so the end of an article which
+        // doesn't fit is still found.
+        constexpr size_t LongestTagLength = sizeof("</REUTERS>") - 1;
+        while (read_line(std::max(LongestTagLength, m_memoryBudget - std::min(m_memoryBudget, m_articleBuffer.length())),
+                         truncated))
+        {
+            const AsciiTextView lineView(m_line.c_str(), m_line.length());
+            if (lineView.starts_with("<REUTERS "))
+            {
+                always_assert(!insideArticle && "Missing closing of article");
+                insideArticle = true;
+            }
+            if (!insideArticle)
+            {
+                continue;
+            }
+
+            if (!overBudget && (truncated || ((m_articleBuffer.length() + m_line.length() + 1) > m_memoryBudget)))
+            {
+                // Rest of the article is only searched for its end, the document id is still used so the ids stay the same
+                // as when the whole file is loaded.
+                overBudget = true;
+                m_articleBuffer.clear();
+                m_lineRanges.clear();
+            }
+            if (overBudget)
+            {
+                if (lineView.starts_with("</REUTERS>"))
+                {
+                    azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red,
+                                           "Skipped article %lu from %s, it doesn't fit into the %lu bytes memory budget.\n",
+                                           m_nextDocId, m_fileName, m_memoryBudget);
+                    ++m_nextDocId;
+                    ++m_skippedArticleCount;
+                    insideArticle = false;
+                    overBudget = false;
+                }
+                continue;
+            }
+
+            m_lineRanges.emplace_back(m_articleBuffer.length(), m_line.length());
+            m_articleBuffer.append(m_line);
+            m_articleBuffer.push_back('\n');
+
+            if (lineView.starts_with("</REUTERS>"))
+            {
+                // Buffer is complete, it won't be reallocated until the next call so the views can be created now.
+                std::vector<AsciiTextView> articleLines(m_lineRanges.size());
+                for (size_t i = 0; i < m_lineRanges.size(); ++i)
+                {
+                    articleLines[i] = AsciiTextView(m_articleBuffer.data() + m_lineRanges[i].first, m_lineRanges[i].second);
+                }
+                article = ReutersArticle(m_nextDocId++, articleLines);
+                return true;
+            }
+        }
+
+        always_assert(!insideArticle && "Missing closing of article");
+        azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Streamed Reuter articles from %s.\n", m_fileName);
+        return false;
+    }
+
+    DocId SgmlArticleReader::get_next_docId() const
+    {
+        return m_nextDocId;
+    }
+
+    size_t SgmlArticleReader::get_skipped_article_count() const
+    {
+        return m_skippedArticleCount;
+    }
+
+    void test_sgml_article_reader()
+    {
+        const std::string path = "/tmp/dis_article_reader_" + std::to_string(getpid()) + ".sgm";
+        constexpr size_t memoryBudget = 64;
+        // Tag lines take 38 bytes and the body its new line, the first article fills the budget exactly. The second one has
+        // only 5 bytes of the budget left for its closing line and must be skipped without losing its end.
+        const std::string tooLargeBody(memoryBudget - 38 - 1 + 6, 'y');
+        {
+            std::ofstream sgml(path);
+            sgml << "<!DOCTYPE lewis SYSTEM \"lewis.dtd\">\n";
+            sgml << "<REUTERS A>\n<TEXT>\n" << std::string(memoryBudget - 38 - 1, 'x') << "\n</TEXT>\n</REUTERS>\n";
+            sgml << "<REUTERS B>\n<TEXT>\n" << tooLargeBody << "\n</TEXT>\n</REUTERS>\n";
+            sgml << "<REUTERS C>\n<TEXT>\nlast\n</TEXT>\n</REUTERS>\n";
+        }
+
+        std::vector<DocId> docIds;
+        {
+            SgmlArticleReader reader(path.c_str(), 1, memoryBudget);
+            ReutersArticle article(0);
+            while (reader.read_next(article))
+            {
+                docIds.push_back(article.get_docId());
+            }
+            if (reader.get_skipped_article_count() != 1)
+                docIds.clear();
+        }
+        std::remove(path.c_str());
+
+        if (docIds == std::vector<DocId>{1, 3})
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Streaming reader budget limits OK\n");
+        else
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Streaming reader budget limits failed\n");
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <fstream>
+#include "ReutersArticle.h"
+
+namespace dis
+{
+    /// Reads Reuters articles one at a time from the SGML file. Only the current article is held in memory and its size is
+    /// limited by the memory budget, so files of any size can be processed. Articles over the budget are skipped and reported.
+    class SgmlArticleReader
+    {
+    private:
+        typedef azgra::string::SmartStringView<char> AsciiTextView;
+
+        std::ifstream m_stream;
+        const char *m_fileName;
+        size_t m_memoryBudget;
+        DocId m_nextDocId;
+        size_t m_skippedArticleCount = 0;
+
+        std::string m_line;
+        std::string m_articleBuffer;
+        std::vector<std::pair<size_t, size_t>> m_lineRanges;
+
+        /// Read the next line into m_line in bounded chunks, characters after the maximal length are skipped.
+        /// \param maxLength Maximal number of kept characters.
+        /// \param truncated Set if the line was longer than the maximal length.
+        /// \return False if there are no more lines.
+        bool read_line(const size_t maxLength, bool &truncated);
+
+    public:
+        static constexpr size_t DefaultMemoryBudget = 4 * 1024 * 1024;
+
+        explicit SgmlArticleReader(const char *fileName, const DocId firstDocId, const size_t memoryBudget = DefaultMemoryBudget);
+
+        /// Read next article from the stream. Views of the article are valid until next call.
+        /// \param article Article to be replaced with the next one.
+        /// \return False if there are no more articles.
+        bool read_next(ReutersArticle &article);
+
+        [[nodiscard]] DocId get_next_docId() const;
+
+        /// Number of articles skipped because they didn't fit into the memory budget.
+        [[nodiscard]] size_t get_skipped_article_count() const;
+    };
+
+    /// Stream articles which fill the memory budget exactly or overflow it right before their end.
+    void test_sgml_article_reader();
+}
@@ -1,5 +1,12 @@
+#include <thread>
+#include <random>
+#include <unistd.h>
+#include <omp.h>
 #include <azgra/collection/enumerable.h>
 #include "sgml_collection.h"
+#include "bounded_queue.h"
+#include "stem_cache.h"
+#include "fibonacci_coding.h"
 
 namespace dis
 {
@@ -40,203 +47,485 @@ namespace dis
         return result;
     }
 
-    static std::pair<size_t, size_t> largest_lte_fib_num_index(const std::vector<size_t> &fibSeq,
-                                                               const size_t target,
-                                                               const size_t maxExclusiveIndex)
+//
+//    void test()
+//    {
+//        const auto delta = create_delta_vector({1, 20, 50, 100, 101, 200, 450, 813, 1568});
+//        const auto delta2 = create_delta_vector({2000, 2500, 3221});
+//        auto fibSeq = generate_fibonacci_sequence(40);
+//        azgra::OutMemoryBitStream bitStream;
+//        encode_delta_with_fibonacci_sequence(bitStream, "ahoj", delta, fibSeq);
+//        encode_delta_with_fibonacci_sequence(bitStream, "svete", delta2, fibSeq);
+//        bitStream.write_value<azgra::u32>(0);
+//
+//        auto buffer = bitStream.get_flushed_buffer();
+//        azgra::InMemoryBitStream bitDecoderStream(&buffer);
+//        auto decodedDeltas = decode_deltas_from_fibonacci_sequence(bitDecoderStream, fibSeq);
+//        //auto reconstructedOriginalValues = reconstruct_from_delta(decodedDeltas[0]);
+//        const auto size = buffer.size();
+//    }
+
+
+    static void print_stem_cache_statistics()
+    {
+        const auto statistics = StemCache::global().get_statistics();
+        fprintf(stdout, "Stem cache: %lu words, %lu hits, %lu misses, hit rate %.2f %%\n", statistics.entries, statistics.hits,
+                statistics.misses, statistics.hit_rate() * 100.0);
+    }
+
+    static double to_MiB(const size_t bytes)
     {
-        always_assert(maxExclusiveIndex > 1);
-        for (auto i = static_cast<size_t>(maxExclusiveIndex - 1); i >= 0; --i)
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    static void print_index_memory_report(const IndexMemoryReport &report, const bool positional,
+                                          const FrozenTermIndex &frozenIndex)
+    {
+        const size_t frozenBytes = frozenIndex.get_memory_bytes();
+        fprintf(stdout, "Index memory: %lu terms, %lu postings, tree index %.2f MiB, frozen index %.2f MiB (%.1f %%)\n",
+                report.termCount, report.postingCount, to_MiB(report.postingBytes), to_MiB(frozenBytes),
+                (report.postingBytes == 0) ? 0.0 : (100.0 * static_cast<double>(frozenBytes) / static_cast<double>(report.postingBytes)));
+        if (positional)
         {
-            if (fibSeq[i] <= target)
-            {
-                //return <value,index>
-                return std::make_pair(fibSeq[i], i);// (maxExclusiveIndex - 1 - i));
-            }
+            const size_t frozenPositionBytes = frozenIndex.get_position_bytes();
+            fprintf(stdout, "Positions: %lu positions, %.2f MiB (%.1f %% of the frozen index, %.2f bytes per position)\n",
+                    report.positionCount, to_MiB(frozenPositionBytes),
+                    (frozenBytes == 0) ? 0.0 : (100.0 * static_cast<double>(frozenPositionBytes) / static_cast<double>(frozenBytes)),
+                    (report.positionCount == 0) ? 0.0 : (static_cast<double>(frozenPositionBytes) / report.positionCount));
         }
-        always_assert(false && "Didn't find fibonacci number!");
-        return std::make_pair(-1, -1);
     }
 
-    static void encode_delta_with_fibonacci_sequence(azgra::io::stream::OutMemoryBitStream &bitStream,
-                                                     const std::string &term,
-                                                     const std::vector<DocId> &delta,
-                                                     const std::vector<size_t> &fibSeq)
+    SgmlFileCollection::SgmlFileCollection(std::vector<const char *> sgmlFilePaths, const CollectionOptions &options)
+    {
+        m_inputFilePaths = std::move(sgmlFilePaths);
+        m_options = options;
+        m_index = TermIndex(std::make_shared<TermDictionary>(), m_options.positionalIndex);
+    }
+
+    void SgmlFileCollection::release_query_indices()
+    {
+        m_mappedIndex.reset();
+        m_compressedIndex.reset();
+        m_lazyIndex.reset();
+        m_frozenIndex = FrozenTermIndex();
+    }
+
+    void SgmlFileCollection::install_frozen_index(FrozenTermIndex &&index)
+    {
+        release_query_indices();
+        m_frozenIndex = std::move(index);
+    }
+
+    void SgmlFileCollection::materialize_frozen_index()
     {
-        // Write term
-        const auto termLen = static_cast<azgra::u32>(term.length());
-        bitStream.write_value(termLen);
-        for (const char &c : term)
+        if ((m_mappedIndex == nullptr) && (m_compressedIndex == nullptr) && (m_lazyIndex == nullptr))
+            return;
+
+        if (!has_term_frequencies())
         {
-            bitStream.write_value<azgra::byte>(c);
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red,
+                                   "Loaded compressed index has no term frequencies, all of them are set to 1.\n");
         }
-        always_assert(delta.size() <= std::numeric_limits<azgra::u32>::max());
-        auto deltaSize = static_cast<azgra::u32> (delta.size());
-        bitStream.write_value(deltaSize);
+        FrozenTermIndex index(m_index.get_shared_dictionary());
+        for_each_posting_list([&index](const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies,
+                                       const size_t count)
+                              { index.append_term(term, docIds, frequencies, count); });
+        index.finish_appending();
+        install_frozen_index(std::move(index));
+        fprintf(stdout, "Materialized loaded index with %lu terms\n", m_frozenIndex.size());
+    }
+
+    void SgmlFileCollection::freeze_index()
+    {
+        install_frozen_index(FrozenTermIndex(m_index));
+        print_index_memory_report(m_index.get_memory_report(), m_index.is_positional(), m_frozenIndex);
+        // Tree postings aren't needed anymore, dictionary is kept for the articles added later.
+        m_index = TermIndex(m_index.get_shared_dictionary(), m_options.positionalIndex);
+    }
+
+    static void print_query_result(const azgra::string::SmartStringView<char> &queryText, const QueryResult &result)
+    {
+        fprintf(stdout, "Query `%s` returned %lu documents\n", queryText.data(), result.documents.size());
+        std::stringstream docStream;
 
-        for (const DocId &value : delta)
+        for (const auto &docId:result.documents)
         {
-            long remaining = static_cast<long> (value);
-            std::vector<size_t> fibIndicis;
-            size_t maxIndex = fibSeq.size();
-            while (remaining > 0)
-            {
-                auto[value, index] = largest_lte_fib_num_index(fibSeq, remaining, maxIndex);
-                fibIndicis.push_back(index);
-                remaining -= value;
-            }
-            const size_t maxFibIndex = azgra::collection::max(fibIndicis.begin(), fibIndicis.end());
-            for (size_t i = 0; i <= maxFibIndex; ++i)
-            {
-                // Index is set write 1
-                const bool bit = std::find(fibIndicis.begin(), fibIndicis.end(), i) != fibIndicis.end();
-                bitStream << bit;
-            }
-            // Write terminating 1.
-            bitStream << true;
+
+            docStream << docId << ',';
         }
+        fprintf(stdout, "Documents:\n%s\n", docStream.str().c_str());
+    }
+
+    template<typename Index>
+    static PostingList get_query_postings(const Index &index, const size_t rank, std::vector<LazyCompressedIndex::DocIds> &)
+    {
+        return index.get_postings(rank);
+    }
+
+    static PostingList get_query_postings(const LazyCompressedIndex &index, const size_t rank,
+                                          std::vector<LazyCompressedIndex::DocIds> &lazyDocIds)
+    {
+        lazyDocIds.push_back(index.get_doc_ids(rank));
+        PostingList postings = {};
+        postings.docIds = lazyDocIds.back()->data();
+        postings.size = lazyDocIds.back()->size();
+        return postings;
     }
 
-    static std::vector<std::pair<std::string, std::vector<DocId>>>
-    decode_deltas_from_fibonacci_sequence(azgra::io::stream::InMemoryBitStream &bitStream, std::vector<size_t> &fibSeq)
+    ArticleFilterOptions SgmlFileCollection::get_article_filter_options() const
     {
-        std::vector<std::pair<std::string, std::vector<DocId>>> deltas;
-        auto termLen = bitStream.read_value<azgra::u32>();
-        std::vector<char> termData(termLen);
-        for (size_t i = 0; i < termLen; ++i)
+        ArticleFilterOptions options = {};
+        options.recordPositions = m_options.positionalIndex;
+        options.keepProcessedText = m_options.keepProcessedText;
+        return options;
+    }
+
+    void SgmlFileCollection::load_and_preprocess_sgml_files(const char *stopwordFile)
+    {
+        const auto stopwords = StopwordSet::load(stopwordFile);
+
+        // Articles get their TermIds during preprocessing, the index created later uses the same dictionary.
+        m_index.clear();
+        m_metadata.clear();
+        if (m_options.parallelLoading)
         {
-            termData[i] = bitStream.read_value<azgra::byte>();
+            load_and_preprocess_sgml_files_parallel(stopwords);
+            return;
         }
-        std::string term = std::string(termData.data(), termLen);
 
-        auto deltaSize = bitStream.read_value<azgra::u32>();
-        do
+        DocId docId = 1;
+        m_sgmlFiles.resize(m_inputFilePaths.size());
+        for (size_t fileIndex = 0; fileIndex < m_inputFilePaths.size(); ++fileIndex)
         {
+            m_sgmlFiles[fileIndex] = SgmlFile::load(m_inputFilePaths[fileIndex], docId, m_options.memoryMappedFiles);
+            m_sgmlFiles[fileIndex].preprocess_article_text(stopwords, m_index.get_dictionary(), get_article_filter_options());
+            m_sgmlFiles[fileIndex].destroy_original_text();
+            m_sgmlFiles[fileIndex].collect_metadata(m_metadata);
+        }
+        documentCount = docId-1;
+        fprintf(stdout, "Document count: %lu\n", documentCount);
+        print_stem_cache_statistics();
+    }
 
-            int deltaValueRemaining = deltaSize;
-            std::vector<DocId> delta;
-            bool prevWasOne = false;
-            std::vector<size_t> fibIndices;
-            long index = -1;
+    void SgmlFileCollection::load_and_preprocess_sgml_files_parallel(const StopwordSet &stopwords)
+    {
+        m_sgmlFiles.resize(m_inputFilePaths.size());
 
-            while (deltaValueRemaining)
-            {
-                ++index;
-                if (bitStream.read_bit())   // 1
-                {
-                    if (prevWasOne)
-                    {
-                        // If previous was one reset here and decode from indices.
-                        size_t result = 0;
-                        for (const size_t &fibIndex : fibIndices)
-                        {
-                            result += fibSeq[fibIndex];
-                        }
-                        delta.push_back(result);
+        // Every file is numbered from zero, the real document ids aren't known until all files are parsed.
+#pragma omp parallel for schedule(dynamic)
+        for (size_t fileIndex = 0; fileIndex < m_inputFilePaths.size(); ++fileIndex)
+        {
+            DocId localDocId = 0;
+            m_sgmlFiles[fileIndex] = SgmlFile::load(m_inputFilePaths[fileIndex], localDocId, m_options.memoryMappedFiles);
+            // Threads are already busy with other files.
+            m_sgmlFiles[fileIndex].preprocess_article_text(stopwords, m_index.get_dictionary(), get_article_filter_options(), false);
+            m_sgmlFiles[fileIndex].destroy_original_text();
+        }
 
-                        --deltaValueRemaining;
-                        index = -1;
-                        fibIndices.clear();
-                        prevWasOne = false;
-                    }
-                    else
-                    {
-                        prevWasOne = true;
-                        fibIndices.push_back(index);
-                    }
-                }
-                else                        // 0
-                {
-                    prevWasOne = false;
-                }
-            }
-            always_assert (delta.size() == static_cast<size_t>(deltaSize));
-            deltas.emplace_back(term, delta);
+        // Prefix sum of the article counts in file order gives every document the id it would get from serial loading.
+        DocId docId = 1;
+        for (auto &sgmlFile : m_sgmlFiles)
+        {
+            sgmlFile.assign_document_ids(docId);
+            sgmlFile.collect_metadata(m_metadata);
+        }
+        documentCount = docId - 1;
+        fprintf(stdout, "Document count: %lu\n", documentCount);
+        print_stem_cache_statistics();
+    }
 
-            termLen = bitStream.read_value<azgra::u32>();
-            if (termLen == 0)
+    void SgmlFileCollection::create_term_index_parallel()
+    {
+        const size_t partCount = std::min(m_sgmlFiles.size(), static_cast<size_t>(std::max(1, omp_get_max_threads())));
+
+        // Ranges are split by article count, so every worker gets about the same number of documents.
+        std::vector<size_t> rangeBegins(partCount + 1, m_sgmlFiles.size());
+        size_t articleCount = 0;
+        for (const auto &sgmlFile : m_sgmlFiles)
+        {
+            articleCount += sgmlFile.get_article_count();
+        }
+        size_t fileIndex = 0;
+        size_t articlesBefore = 0;
+        for (size_t part = 0; part < partCount; ++part)
+        {
+            rangeBegins[part] = fileIndex;
+            const size_t rangeEnd = ((part + 1) * articleCount) / partCount;
+            while ((fileIndex < m_sgmlFiles.size()) && ((articlesBefore < rangeEnd) || (part + 1 == partCount)))
             {
-                break;
+                articlesBefore += m_sgmlFiles[fileIndex++].get_article_count();
             }
-            termData.resize(termLen);
-            for (size_t i = 0; i < termLen; ++i)
+        }
+
+        // Document ids grow with file order, so the partial postings are disjoint and ordered by part.
+        std::vector<FrozenTermIndex> partialIndices(partCount);
+        std::vector<IndexMemoryReport> partialReports(partCount);
+        size_t termCount = 0;
+#pragma omp parallel for schedule(static, 1) reduction(max:termCount)
+        for (size_t part = 0; part < partCount; ++part)
+        {
+            TermIndex partialIndex(m_index.get_shared_dictionary(), m_options.positionalIndex);
+            for (size_t file = rangeBegins[part]; file < rangeBegins[part + 1]; ++file)
             {
-                termData[i] = bitStream.read_value<azgra::byte>();
+                m_sgmlFiles[file].index_atricles(partialIndex);
             }
-            term = std::string(termData.data(), termLen);
-            deltaSize = bitStream.read_value<azgra::u32>();
-        } while (deltaSize);
-        return deltas;
+            termCount = std::max(termCount, partialIndex.size());
+            partialReports[part] = partialIndex.get_memory_report();
+            partialIndices[part] = FrozenTermIndex(partialIndex);
+        }
+        install_frozen_index(FrozenTermIndex::concatenate(partialIndices));
+        fprintf(stdout, "Created index with %lu terms from %lu partial indices (largest %lu terms)\n",
+                m_frozenIndex.size(), partCount, termCount);
+
+        // Partial trees are reported together, terms shared by the parts are counted once.
+        IndexMemoryReport report = {};
+        for (const IndexMemoryReport &partialReport : partialReports)
+        {
+            report.postingCount += partialReport.postingCount;
+            report.postingBytes += partialReport.postingBytes;
+            report.positionCount += partialReport.positionCount;
+            report.positionBytes += partialReport.positionBytes;
+        }
+        report.termCount = m_frozenIndex.size();
+        print_index_memory_report(report, m_options.positionalIndex, m_frozenIndex);
     }
 
-//
-//    void test()
-//    {
-//        const auto delta = create_delta_vector({1, 20, 50, 100, 101, 200, 450, 813, 1568});
-//        const auto delta2 = create_delta_vector({2000, 2500, 3221});
-//        auto fibSeq = generate_fibonacci_sequence(40);
-//        azgra::OutMemoryBitStream bitStream;
-//        encode_delta_with_fibonacci_sequence(bitStream, "ahoj", delta, fibSeq);
-//        encode_delta_with_fibonacci_sequence(bitStream, "svete", delta2, fibSeq);
-//        bitStream.write_value<azgra::u32>(0);
-//
-//        auto buffer = bitStream.get_flushed_buffer();
-//        azgra::InMemoryBitStream bitDecoderStream(&buffer);
-//        auto decodedDeltas = decode_deltas_from_fibonacci_sequence(bitDecoderStream, fibSeq);
-//        //auto reconstructedOriginalValues = reconstruct_from_delta(decodedDeltas[0]);
-//        const auto size = buffer.size();
-//    }
+    void SgmlFileCollection::create_term_index_with_vector_model()
+    {
+        m_index = TermIndex(m_index.get_shared_dictionary(), m_options.positionalIndex);
 
+        if (m_options.parallelIndexing)
+        {
+            create_term_index_parallel();
+            m_vectorModel = VectorModel(m_frozenIndex, documentCount);
+            return;
+        }
+
+        for (const auto &sgmlFile : m_sgmlFiles)
+        {
+            sgmlFile.index_atricles(m_index);
+        }
+        fprintf(stdout, "Created index with %lu terms\n", m_index.size());
+        freeze_index();
+        m_vectorModel = VectorModel(m_frozenIndex, documentCount);
+    }
 
-    SgmlFileCollection::SgmlFileCollection(std::vector<const char *> sgmlFilePaths)
+    void SgmlFileCollection::stream_term_index_with_vector_model(const char *stopwordFile)
     {
-        m_inputFilePaths = std::move(sgmlFilePaths);
+        const auto stopwords = StopwordSet::load(stopwordFile);
+        m_sgmlFiles.clear();
+        m_index.clear();
+        m_metadata.clear();
+
+        // Articles go straight from the reader to the index, only one article is resident at a time.
+        DocId docId = 1;
+        ReutersArticle article(0);
+        for (const char *filePath : m_inputFilePaths)
+        {
+            SgmlArticleReader reader(filePath, docId, m_options.streamingMemoryBudget);
+            while (reader.read_next(article))
+            {
+                article.filter_article_text(stopwords, m_index.get_dictionary(), get_article_filter_options());
+                article.destroy_views();
+                article.index_article_terms(m_index);
+                m_metadata.add_article(article.get_docId(), article.release_metadata());
+            }
+            docId = reader.get_next_docId();
+        }
+        documentCount = docId - 1;
+        fprintf(stdout, "Document count: %lu\n", documentCount);
+        print_stem_cache_statistics();
+        fprintf(stdout, "Created index with %lu terms\n", m_index.size());
+        freeze_index();
+        m_vectorModel = VectorModel(m_frozenIndex, documentCount);
     }
 
-    void SgmlFileCollection::load_and_preprocess_sgml_files(const char *stopwordFile)
+    void SgmlFileCollection::spimi_term_index(const char *stopwordFile, const char *indexFile)
     {
-        const auto stopwords = strings_to_views(azgra::io::read_lines(stopwordFile));
+        const auto stopwords = StopwordSet::load(stopwordFile);
+        m_sgmlFiles.clear();
+        m_index.clear();
+        m_metadata.clear();
 
+        // Only the term dictionary and the current block stay in memory, positions and metadata aren't collected.
+        SpimiIndexBuilder builder(m_index.get_shared_dictionary(), m_options.spimiMemoryBudget, m_options.spimiTempDirectory);
         DocId docId = 1;
-        m_sgmlFiles.resize(m_inputFilePaths.size());
-        for (size_t fileIndex = 0; fileIndex < m_inputFilePaths.size(); ++fileIndex)
+        ReutersArticle article(0);
+        for (const char *filePath : m_inputFilePaths)
         {
-            m_sgmlFiles[fileIndex] = SgmlFile::load(m_inputFilePaths[fileIndex], docId);
-            m_sgmlFiles[fileIndex].preprocess_article_text(stopwords);
-            m_sgmlFiles[fileIndex].destroy_original_text();
+            SgmlArticleReader reader(filePath, docId, m_options.streamingMemoryBudget);
+            while (reader.read_next(article))
+            {
+                article.filter_article_text(stopwords, m_index.get_dictionary());
+                article.destroy_views();
+                builder.add_article(article.get_docId(), article.get_term_frequencies());
+            }
+            docId = reader.get_next_docId();
         }
-        documentCount = docId-1;
+        documentCount = docId - 1;
         fprintf(stdout, "Document count: %lu\n", documentCount);
+        print_stem_cache_statistics();
+
+        const size_t termCount = builder.write_index(indexFile);
+        fprintf(stdout, "Created index with %lu terms and %lu postings from %lu runs\n", termCount, builder.get_posting_count(),
+                builder.get_run_count());
     }
 
-    void SgmlFileCollection::create_term_index_with_vector_model()
+    void SgmlFileCollection::pipelined_term_index_with_vector_model(const char *stopwordFile)
     {
+        struct PipelineItem
+        {
+            ReutersArticle *article;
+            size_t fileIndex;
+        };
+
+        const auto stopwords = StopwordSet::load(stopwordFile);
+        size_t workerCount = m_options.pipelineWorkerCount;
+        if (workerCount == 0)
+        {
+            workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Files are stored in place, so the articles don't move while the pipeline holds pointers to them.
+        m_sgmlFiles.clear();
+        m_sgmlFiles.resize(m_inputFilePaths.size());
         m_index.clear();
+        m_metadata.clear();
+        std::vector<size_t> remainingArticles(m_inputFilePaths.size(), 0);
+        BoundedQueue<PipelineItem> tokenizeQueue(m_options.pipelineQueueCapacity);
+        BoundedQueue<PipelineItem> indexQueue(m_options.pipelineQueueCapacity);
 
-        for (const auto &sgmlFile : m_sgmlFiles)
+        DocId docId = 1;
+        std::thread reader([&]()
+                           {
+                               for (size_t fileIndex = 0; fileIndex < m_inputFilePaths.size(); ++fileIndex)
+                               {
+                                   SgmlFile &sgmlFile = m_sgmlFiles[fileIndex];
+                                   sgmlFile = SgmlFile::load(m_inputFilePaths[fileIndex], docId, m_options.memoryMappedFiles);
+                                   remainingArticles[fileIndex] = sgmlFile.get_article_count();
+                                   for (size_t i = 0; i < sgmlFile.get_article_count(); ++i)
+                                   {
+                                       tokenizeQueue.push({&sgmlFile.get_article(i), fileIndex});
+                                   }
+                               }
+                               tokenizeQueue.close();
+                           });
+
+        std::vector<std::thread> tokenizers;
+        for (size_t worker = 0; worker < workerCount; ++worker)
         {
-            sgmlFile.index_atricles(m_index);
+            tokenizers.emplace_back([&]()
+                                    {
+                                        PipelineItem item = {};
+                                        while (tokenizeQueue.pop(item))
+                                        {
+                                            item.article->filter_article_text(stopwords, m_index.get_dictionary(),
+                                                                              get_article_filter_options());
+                                            item.article->destroy_views();
+                                            indexQueue.push(item);
+                                        }
+                                    });
+        }
+        std::thread tokenizersJoiner([&]()
+                                     {
+                                         for (auto &tokenizer : tokenizers)
+                                         {
+                                             tokenizer.join();
+                                         }
+                                         indexQueue.close();
+                                     });
+
+        // Indexing stage runs on this thread. Original text of the file is released once all its articles are indexed.
+        PipelineItem item = {};
+        while (indexQueue.pop(item))
+        {
+            item.article->index_article_terms(m_index);
+            m_metadata.add_article(item.article->get_docId(), item.article->release_metadata());
+            if (--remainingArticles[item.fileIndex] == 0)
+            {
+                m_sgmlFiles[item.fileIndex].destroy_original_text();
+            }
+        }
+        reader.join();
+        tokenizersJoiner.join();
+
+        for (auto &sgmlFile : m_sgmlFiles)
+        {
+            sgmlFile.destroy_original_text();
         }
+        documentCount = docId - 1;
+        fprintf(stdout, "Document count: %lu\n", documentCount);
+        print_stem_cache_statistics();
         fprintf(stdout, "Created index with %lu terms\n", m_index.size());
-        m_vectorModel = VectorModel(m_index, documentCount);
+        freeze_index();
+        m_vectorModel = VectorModel(m_frozenIndex, documentCount);
+    }
+
+    void SgmlFileCollection::add_files(const std::vector<const char *> &sgmlFilePaths, const char *stopwordFile)
+    {
+        const auto stopwords = StopwordSet::load(stopwordFile);
+
+        // Documents are merged into the frozen index, loaded index is converted first and the new document ids follow
+        // the loaded ones.
+        materialize_frozen_index();
+        documentCount = std::max(documentCount, m_frozenIndex.get_max_doc_id());
+
+        // Delta index shares the dictionary, so new documents get the TermIds of the terms already in the index.
+        DocId docId = documentCount + 1;
+        TermIndex deltaIndex(m_index.get_shared_dictionary(), m_index.is_positional());
+        for (const char *filePath : sgmlFilePaths)
+        {
+            SgmlFile sgmlFile = SgmlFile::load(filePath, docId, m_options.memoryMappedFiles);
+            sgmlFile.preprocess_article_text(stopwords, deltaIndex.get_dictionary(), get_article_filter_options());
+            sgmlFile.destroy_original_text();
+            sgmlFile.index_atricles(deltaIndex);
+            sgmlFile.collect_metadata(m_metadata);
+
+            m_inputFilePaths.push_back(filePath);
+            m_sgmlFiles.push_back(std::move(sgmlFile));
+        }
+        documentCount = docId - 1;
+
+        const FrozenTermIndex frozenDelta(deltaIndex);
+        m_frozenIndex = FrozenTermIndex::merge(m_frozenIndex, frozenDelta);
+        fprintf(stdout, "Added %lu terms of new documents, index has %lu terms\n", frozenDelta.size(), m_frozenIndex.size());
+        if (m_vectorModel.can_add_documents(frozenDelta))
+        {
+            m_vectorModel.add_documents(frozenDelta, documentCount);
+        }
+        else
+        {
+            // Loaded indices have no model, or the model uses the dictionary replaced by the load.
+            m_vectorModel = VectorModel(m_frozenIndex, documentCount);
+        }
     }
 
     void SgmlFileCollection::dump_index(const char *path)
     {
-        std::ofstream dump(path, std::ios::out);
-        for (const auto &term : m_index)
+        if (!has_term_frequencies())
         {
-            dump << term.first << ':';
-            for (const DocumentOccurence &docOcc : term.second)
-            {
-                dump << docOcc.docId << ",";
-            }
-            dump << "\n";
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red,
+                                   "Loaded compressed index has no term frequencies, all of them are written as 1.\n");
         }
+        BinaryIndexWriter writer(path);
+        for_each_posting_list([&writer](const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *frequencies,
+                                        const size_t count)
+                              { writer.add_term(term, docIds, frequencies, count); });
+        writer.finish();
     }
 
     void SgmlFileCollection::load_index(const char *path)
     {
         m_index.clear();
+        if (is_binary_index(path))
+        {
+            release_query_indices();
+            m_mappedIndex = std::make_unique<MappedTermIndex>(path);
+            documentCount = m_mappedIndex->get_max_doc_id();
+            fprintf(stdout, "Mapped index with %lu terms and %lu postings\n", m_mappedIndex->size(),
+                    m_mappedIndex->get_posting_count());
+            return;
+        }
         std::vector<std::pair<std::string, std::set<DocumentOccurence>>> mapPairs;
         std::function<std::pair<std::string, std::set<DocumentOccurence>>(const azgra::string::SmartStringView<char> &)> fn =
                 [](const azgra::string::SmartStringView<char> &line)
@@ -249,19 +538,30 @@ namespace dis
                     {
                         if (!dIdStr.is_empty())
                         {
-                            ids.insert(DocumentOccurence(atol(dIdStr.data()), 0));
+                            ids.insert(DocumentOccurence(atol(dIdStr.data()), 1));
                         }
                     }
                     return std::make_pair(term, ids);
                 };
 
         mapPairs = azgra::io::parse_by_lines<std::pair<std::string, std::set<DocumentOccurence>>>(path, fn);
-        m_index = TermIndex(mapPairs.begin(), mapPairs.end());
+        for (const auto &[term, occurencies] : mapPairs)
+        {
+            m_index.add_occurencies(m_index.get_dictionary().intern(term), occurencies);
+        }
         fprintf(stdout, "%lu\n", mapPairs.size());
+        freeze_index();
+        documentCount = m_frozenIndex.get_max_doc_id();
     }
 
     void SgmlFileCollection::save_preprocessed_documents(const char *path)
     {
+        if (!m_options.keepProcessedText)
+        {
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red,
+                                   "Processed text isn't kept, enable CollectionOptions::keepProcessedText.\n");
+            return;
+        }
         std::ofstream fStream(path, std::ios::out);
         always_assert(fStream.is_open());
 
@@ -275,7 +575,7 @@ namespace dis
         }
     }
 
-    QueryResult SgmlFileCollection::query(azgra::string::SmartStringView<char> &queryText, const bool verbose) const
+    QueryResult SgmlFileCollection::query(azgra::string::SmartStringView<char> &queryText, const bool verbose, const char *filter) const
     {
         QueryResult result = {};
         if (queryText.is_empty())
@@ -283,34 +583,69 @@ namespace dis
             azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Query string is empty.\n");
             return result;
         }
-        if (m_index.empty())
+        bool indexEmpty;
+        if (m_compressedIndex != nullptr)
+            indexEmpty = m_compressedIndex->empty();
+        else if (m_lazyIndex != nullptr)
+            indexEmpty = m_lazyIndex->empty();
+        else
+            indexEmpty = with_query_index([](const auto &index)
+                                          { return index.empty(); });
+        if (indexEmpty)
         {
             azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Index wasn't created nor loaded.\n");
             return result;
         }
+        DocumentBitmap filterBitmap;
+        if ((filter != nullptr) && !m_metadata.evaluate_filter(filter, filterBitmap))
+        {
+            return result;
+        }
 
         auto keywords = queryText.split(" ");
-        std::vector<SizedIndexEntry> indexEntries;
-        for (const auto &keyword : keywords)
+        std::vector<DocId> unionVector;
+        if (m_compressedIndex != nullptr)
         {
-            AsciiString str = stem_word(keyword.data(), keyword.length());
-            const std::string key = std::string(str.get_c_string());
-            if (keyword.is_empty() || (m_index.find(key) == m_index.end()))
+            if (!intersect_compressed_postings(keywords, (filter != nullptr) ? &filterBitmap : nullptr, verbose, unionVector))
             {
-                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Term %s is not found in any documents.\n",
-                                       key.c_str());
                 return result;
             }
-            else
+            result.documents = std::set<DocId>(unionVector.begin(), unionVector.end());
+            if (verbose)
             {
-                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Cyan, "Term %s is found in %lu documents.\n",
-                                       key.c_str(), m_index.at(key).size());
-
+                print_query_result(queryText, result);
             }
+            return result;
+        }
 
+        std::vector<PostingList> indexEntries;
+        // Lists decoded by the lazy index stay valid until the query ends, even if the cache evicts them meanwhile.
+        std::vector<LazyCompressedIndex::DocIds> lazyDocIds;
+        const auto findPostings = [&keywords, &indexEntries, &lazyDocIds](const auto &index)
+        {
+            std::string stemBuffer;
+            for (const auto &keyword : keywords)
+            {
+                const std::string_view key = cached_stem_word(keyword.data(), keyword.length(), stemBuffer);
+                const size_t rank = keyword.is_empty() ? FrozenTermIndex::NotFound : index.find(key);
+                if (rank == FrozenTermIndex::NotFound)
+                {
+                    azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Term %.*s is not found in any documents.\n",
+                                           static_cast<int>(key.length()), key.data());
+                    return false;
+                }
+                const PostingList postings = get_query_postings(index, rank, lazyDocIds);
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Cyan, "Term %.*s is found in %lu documents.\n",
+                                       static_cast<int>(key.length()), key.data(), postings.size);
 
-            indexEntries.push_back(SizedIndexEntry(m_index.at(key))); // NOLINT(hicpp-use-emplace,
-            // modernize-use-emplace)
+                indexEntries.push_back(postings);
+            }
+            return true;
+        };
+        const bool allTermsFound = (m_lazyIndex != nullptr) ? findPostings(*m_lazyIndex) : with_query_index(findPostings);
+        if (!allTermsFound)
+        {
+            return result;
         }
 
         if (indexEntries.empty())
@@ -322,8 +657,15 @@ namespace dis
         std::sort(indexEntries.begin(), indexEntries.end());
 
         //result.documents = indexEntries[0].documents;
-        std::vector<DocId> unionVector = std::vector<DocId>(indexEntries[0].documents.begin(),
-                                                            indexEntries[0].documents.end());
+        // Filter is applied to the shortest posting list, before any intersection is done.
+        for (size_t i = 0; i < indexEntries[0].size; ++i)
+        {
+            const DocId docId = indexEntries[0].docIds[i];
+            if ((filter == nullptr) || filterBitmap.test(docId))
+            {
+                unionVector.push_back(docId);
+            }
+        }
         if (indexEntries.size() > 1)
         {
             for (size_t i = 1; i < indexEntries.size(); ++i)
@@ -331,8 +673,8 @@ namespace dis
                 std::vector<DocId> unionResult;
                 unionResult.clear();
                 std::set_intersection(unionVector.begin(), unionVector.end(),
-                                      indexEntries[i].documents.begin(),
-                                      indexEntries[i].documents.end(),
+                                      indexEntries[i].docIds,
+                                      indexEntries[i].docIds + indexEntries[i].size,
                                       std::back_inserter(unionResult));
                 unionVector = unionResult;
             }
@@ -341,34 +683,56 @@ namespace dis
 
         if (verbose)
         {
-            fprintf(stdout, "Query `%s` returned %lu documents\n", queryText.data(), result.documents.size());
-            std::stringstream docStream;
-
-            for (const auto &docId:result.documents)
+            print_query_result(queryText, result);
+            if (m_lazyIndex != nullptr)
             {
-
-                docStream << docId << ',';
+                const auto statistics = m_lazyIndex->get_cache_statistics();
+                fprintf(stdout, "Posting cache: %lu lists, %.2f MiB, %lu hits, %lu misses\n", statistics.entries,
+                        to_MiB(statistics.bytes), statistics.hits, statistics.misses);
             }
-            fprintf(stdout, "Documents:\n%s\n", docStream.str().c_str());
         }
 
         return result;
     }
 
-    void SgmlFileCollection::dump_compressed_index(const char *filePath) const
+    void SgmlFileCollection::dump_compressed_index(const char *filePath, const PostingsCodecType codec) const
     {
-        auto fibSeq = generate_fibonacci_sequence(50);
-        azgra::io::stream::OutMemoryBitStream bitStream;
-        for (const auto&[term, documentSet] : m_index)
+        if (m_options.compressedIndexShardCount != 0)
+        {
+            dump_sharded_index(filePath, codec);
+            return;
+        }
+        if (codec != PostingsCodecType::Fibonacci)
         {
-            auto documentVector = azgra::collection::select(documentSet.begin(),
-                                                            documentSet.end(),
-                                                            [](const DocumentOccurence &occurence)
-                                                            { return occurence.docId; });
-            std::sort(documentVector.begin(), documentVector.end());
-            auto deltaVector = create_delta_vector(documentVector);
-            encode_delta_with_fibonacci_sequence(bitStream, term, deltaVector, fibSeq);
+            CodecIndexWriter writer(codec);
+            for_each_posting_list([&writer](const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *,
+                                            const size_t count)
+                                  { writer.add_term(term, docIds, count); });
+            writer.write(filePath);
+            return;
         }
+
+        const BitStreamLayout *layout = get_bit_stream_layout();
+        if (layout != nullptr)
+        {
+            FibonacciIndexWriter writer(*layout);
+            for_each_posting_list([&writer](const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *,
+                                            const size_t count)
+                                  { writer.add_term(term, docIds, count); });
+            azgra::io::dump_bytes(writer.finish(true), filePath);
+            return;
+        }
+
+        // Bit serial coding through the bit stream, when the table driven writer can't reproduce its layout.
+        auto fibSeq = generate_fibonacci_sequence(50);
+        azgra::io::stream::OutMemoryBitStream bitStream;
+        for_each_posting_list([&bitStream, &fibSeq](const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *,
+                                                    const size_t count)
+                              {
+                                  const std::vector<DocId> documentVector(docIds, docIds + count);
+                                  auto deltaVector = create_delta_vector(documentVector);
+                                  encode_delta_with_fibonacci_sequence(bitStream, std::string(term), deltaVector, fibSeq);
+                              });
         bitStream.write_value<azgra::u32>(0);
         const auto buffer = bitStream.get_flushed_buffer();
         azgra::io::dump_bytes(buffer, filePath);
@@ -377,28 +741,218 @@ namespace dis
     void SgmlFileCollection::load_compressed_index(const char *filePath)
     {
         fprintf(stdout, "Loading compressed index...\n");
-        auto fibSeq = generate_fibonacci_sequence(50);
+        if (m_options.lazyCompressedIndex)
+        {
+            if (LazyCompressedIndex::can_open(filePath))
+            {
+                m_index.clear();
+                release_query_indices();
+                m_lazyIndex = std::make_unique<LazyCompressedIndex>(filePath, m_options.postingCacheCapacity);
+                fprintf(stdout, "Opened compressed index with %lu terms and %lu postings, postings are decoded on demand\n",
+                        m_lazyIndex->size(), m_lazyIndex->get_posting_count());
+                return;
+            }
+            fprintf(stdout, "Compressed index has no term directory, it is loaded eagerly.\n");
+        }
+        if (is_sharded_index(filePath))
+        {
+            load_sharded_index(filePath);
+            return;
+        }
+        auto index = std::make_unique<CompressedTermIndex>();
+        if (is_codec_index(filePath))
+        {
+            CodecIndexReader reader(filePath);
+            fprintf(stdout, "Decoding %s coded document ids...\n", reader.get_codec().get_name());
+            while (reader.read_next())
+            {
+                index->add_term(reader.get_term(), reader.get_doc_ids().data(), reader.get_doc_ids().size());
+            }
+            index->finish();
+            set_compressed_index(std::move(index));
+            documentCount = m_compressedIndex->get_max_doc_id();
+            return;
+        }
+
         azgra::io::stream::InBinaryFileStream compressedIndexBinaryStream(filePath);
         const auto buffer = compressedIndexBinaryStream.consume_whole_file();
+        const BitStreamLayout *layout = get_bit_stream_layout();
+        if (layout != nullptr)
+        {
+            FibonacciIndexReader reader(buffer, *layout);
+            while (reader.read_next())
+            {
+                index->add_term(reader.get_term(), reader.get_doc_ids().data(), reader.get_doc_ids().size());
+            }
+            index->finish();
+            set_compressed_index(std::move(index));
+            documentCount = m_compressedIndex->get_max_doc_id();
+            return;
+        }
+
+        auto fibSeq = generate_fibonacci_sequence(50);
         azgra::io::stream::InMemoryBitStream bitStream(&buffer);
         fprintf(stdout, "Decoding delta values...\n");
         const auto decompressedIndexPairs = decode_deltas_from_fibonacci_sequence(bitStream, fibSeq);
 
-        m_index.clear();
+        std::vector<azgra::u32> docIds;
         for (const auto&[term, deltaVector] : decompressedIndexPairs)
         {
             const auto ids = reconstruct_from_delta(deltaVector);
-            const auto occurrencies = azgra::collection::select(ids.begin(), ids.end(),
-                                                                [](const DocId &docId)
-                                                                {
-                                                                    return DocumentOccurence(docId, 0);
-                                                                });
-            const auto documentIds = azgra::collection::vector_as_set(occurrencies);
-            m_index.emplace(term, documentIds);
-            //m_index[term] = documentIds;
+            docIds.assign(ids.begin(), ids.end());
+            index->add_term(term, docIds.data(), docIds.size());
         }
-        fprintf(stdout, "Loaded index with %lu terms.\n", m_index.size());
+        index->finish();
+        set_compressed_index(std::move(index));
+        documentCount = m_compressedIndex->get_max_doc_id();
+    }
 
+    void SgmlFileCollection::dump_sharded_index(const char *filePath, const PostingsCodecType codec) const
+    {
+        ShardedIndexWriter writer(codec, m_options.compressedIndexShardCount, get_term_count());
+        // Shards hold the same number of terms but not of postings, dynamic schedule evens out the frequent terms.
+#pragma omp parallel for schedule(dynamic)
+        for (size_t shard = 0; shard < writer.get_shard_count(); ++shard)
+        {
+            for_each_posting_list(writer.get_shard_begin(shard), writer.get_shard_end(shard),
+                                  [&writer, shard](const std::string_view &term, const azgra::u32 *docIds, const azgra::u32 *,
+                                                   const size_t count)
+                                  { writer.add_term(shard, term, docIds, count); });
+        }
+        writer.write(filePath);
+        fprintf(stdout, "Wrote compressed index in %lu shards\n", writer.get_shard_count());
+    }
+
+    void SgmlFileCollection::load_sharded_index(const char *filePath)
+    {
+        const ShardedIndexReader reader(filePath);
+        fprintf(stdout, "Decoding %lu shards of %s coded document ids...\n", reader.get_shard_count(), reader.get_codec().get_name());
+        std::vector<std::unique_ptr<CompressedTermIndex>> shardIndices(reader.get_shard_count());
+#pragma omp parallel for schedule(dynamic)
+        for (size_t shard = 0; shard < reader.get_shard_count(); ++shard)
+        {
+            auto shardIndex = std::make_unique<CompressedTermIndex>();
+            IndexShardReader shardReader = reader.open_shard(shard);
+            while (shardReader.read_next())
+            {
+                shardIndex->add_term(shardReader.get_term(), shardReader.get_doc_ids().data(), shardReader.get_doc_ids().size());
+            }
+            shardIndices[shard] = std::move(shardIndex);
+        }
+
+        // Shards are consecutive ranges of the sorted terms, so their blocks are only appended.
+        auto index = std::make_unique<CompressedTermIndex>();
+        for (auto &shardIndex : shardIndices)
+        {
+            index->append(*shardIndex);
+            shardIndex.reset();
+        }
+        index->finish();
+        set_compressed_index(std::move(index));
+        documentCount = m_compressedIndex->get_max_doc_id();
+    }
+
+    void SgmlFileCollection::set_compressed_index(std::unique_ptr<CompressedTermIndex> index)
+    {
+        m_index.clear();
+        release_query_indices();
+        m_compressedIndex = std::move(index);
+        fprintf(stdout, "Compressed index with %lu terms, %lu postings in %lu %s blocks, %.2f MiB\n", m_compressedIndex->size(),
+                m_compressedIndex->get_posting_count(), m_compressedIndex->get_block_count(),
+                m_compressedIndex->get_codec().get_name(), to_MiB(m_compressedIndex->get_memory_bytes()));
+    }
+
+    void SgmlFileCollection::compress_index(const PostingsCodecType codec)
+    {
+        // Frequencies are kept only if the active index has them, so dump_index can still write them.
+        auto index = std::make_unique<CompressedTermIndex>(codec);
+        const bool keepFrequencies = has_term_frequencies();
+        for_each_posting_list([&index, keepFrequencies](const std::string_view &term, const azgra::u32 *docIds,
+                                                        const azgra::u32 *frequencies, const size_t count)
+                              { index->add_term(term, docIds, keepFrequencies ? frequencies : nullptr, count); });
+        index->finish();
+        set_compressed_index(std::move(index));
+    }
+
+    bool SgmlFileCollection::intersect_compressed_postings(const std::vector<azgra::string::SmartStringView<char>> &keywords,
+                                                           const DocumentBitmap *filterBitmap, const bool verbose,
+                                                           std::vector<DocId> &documents) const
+    {
+        std::vector<PostingCursor> cursors;
+        std::string stemBuffer;
+        for (const auto &keyword : keywords)
+        {
+            const std::string_view key = cached_stem_word(keyword.data(), keyword.length(), stemBuffer);
+            const size_t rank = keyword.is_empty() ? CompressedTermIndex::NotFound : m_compressedIndex->find(key);
+            if (rank == CompressedTermIndex::NotFound)
+            {
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Term %.*s is not found in any documents.\n",
+                                       static_cast<int>(key.length()), key.data());
+                return false;
+            }
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Cyan, "Term %.*s is found in %lu documents.\n",
+                                   static_cast<int>(key.length()), key.data(), m_compressedIndex->get_posting_count(rank));
+            cursors.push_back(m_compressedIndex->get_cursor(rank));
+        }
+        if (cursors.empty())
+        {
+            return true;
+        }
+
+        // Rarest term drives the intersection, the other cursors only skip to its candidates.
+        std::sort(cursors.begin(), cursors.end(), [](const PostingCursor &a, const PostingCursor &b)
+        { return a.get_block_count() < b.get_block_count(); });
+        PostingCursor &lead = cursors[0];
+        bool hasCandidate = lead.next();
+        while (hasCandidate)
+        {
+            const azgra::u32 candidate = lead.doc_id();
+            if ((filterBitmap != nullptr) && !filterBitmap->test(candidate))
+            {
+                hasCandidate = lead.next();
+                continue;
+            }
+
+            azgra::u32 nextCandidate = candidate;
+            for (size_t i = 1; i < cursors.size(); ++i)
+            {
+                if (!cursors[i].advance_to(candidate))
+                {
+                    hasCandidate = false;
+                    break;
+                }
+                if (cursors[i].doc_id() != candidate)
+                {
+                    nextCandidate = cursors[i].doc_id();
+                    break;
+                }
+            }
+            if (!hasCandidate)
+                break;
+
+            if (nextCandidate == candidate)
+            {
+                documents.push_back(candidate);
+                hasCandidate = lead.next();
+            }
+            else
+            {
+                hasCandidate = lead.advance_to(nextCandidate);
+            }
+        }
+
+        if (verbose)
+        {
+            size_t decodedBlocks = 0;
+            size_t totalBlocks = 0;
+            for (const PostingCursor &cursor : cursors)
+            {
+                decodedBlocks += cursor.get_decoded_block_count();
+                totalBlocks += cursor.get_block_count();
+            }
+            fprintf(stdout, "Decoded %lu of %lu posting blocks.\n", decodedBlocks, totalBlocks);
+        }
+        return true;
     }
 
     VectorModel &SgmlFileCollection::get_vector_model()
@@ -406,21 +960,151 @@ namespace dis
         return m_vectorModel;
     }
 
-    std::vector<size_t> generate_fibonacci_sequence(const size_t N)
+    const ArticleMetadataStore &SgmlFileCollection::get_metadata() const
+    {
+        return m_metadata;
+    }
+
+    /// Write stopwords and generated SGML files with overlapping vocabularies.
+    /// \return Path of the stopword file.
+    static std::string write_test_collection(const std::string &prefix, const size_t fileCount, std::vector<std::string> &filePaths)
+    {
+        const std::string stopwordFile = prefix + "_stopwords.txt";
+        {
+            std::ofstream stopwords(stopwordFile);
+            stopwords << "the\nof\nand\n";
+        }
+
+        const char *words[] = {"grain", "wheat", "oil", "price", "the", "market", "trade", "of", "bank", "rate", "export", "and"};
+        std::mt19937 generator(42);
+        filePaths.clear();
+        for (size_t file = 0; file < fileCount; ++file)
+        {
+            filePaths.push_back(prefix + "_" + std::to_string(file) + ".sgm");
+            std::ofstream sgml(filePaths.back());
+            sgml << "<!DOCTYPE lewis SYSTEM \"lewis.dtd\">\n";
+            for (size_t article = 0; article < 20 + (file * 7); ++article)
+            {
+                sgml << "<REUTERS NEWID=\"" << article << "\">\n<TEXT>\n";
+                for (size_t word = 0; word < 1 + (generator() % 40); ++word)
+                {
+                    sgml << words[generator() % (sizeof(words) / sizeof(words[0]))] << (((word % 8) == 7) ? '\n' : ' ');
+                }
+                sgml << "\n</TEXT>\n</REUTERS>\n";
+            }
+        }
+        return stopwordFile;
+    }
+
+    void test_parallel_term_index()
     {
-        int n = N + 1;
-        std::vector<size_t> fibN(N);
-        size_t a = 0;
-        size_t b = 1;
-        size_t i = 0;
-        while (n-- > 1)
+        const std::string directory = "/tmp/dis_parallel_index_" + std::to_string(getpid());
+        // Several files, so the partial indices share terms.
+        std::vector<std::string> filePaths;
+        const std::string stopwordFile = write_test_collection(directory, 5, filePaths);
+        std::vector<const char *> fileNames;
+        for (const auto &filePath : filePaths)
+        {
+            fileNames.push_back(filePath.c_str());
+        }
+
+        std::string indexPaths[2];
+        for (int parallel = 0; parallel < 2; ++parallel)
         {
-            size_t t = a;
-            a = b;
-            b += t;
-            fibN[i++] = b;
+            CollectionOptions options;
+            options.parallelIndexing = (parallel == 1);
+            SgmlFileCollection collection(fileNames, options);
+            collection.load_and_preprocess_sgml_files(stopwordFile.c_str());
+            collection.create_term_index_with_vector_model();
+            indexPaths[parallel] = directory + (options.parallelIndexing ? "_parallel.index" : "_serial.index");
+            collection.dump_index(indexPaths[parallel].c_str());
+        }
+
+        size_t failed = 0;
+        {
+            const MappedTermIndex serialIndex(indexPaths[0].c_str());
+            const MappedTermIndex parallelIndex(indexPaths[1].c_str());
+            if (serialIndex.size() != parallelIndex.size())
+                ++failed;
+            for (size_t rank = 0; (failed == 0) && (rank < serialIndex.size()); ++rank)
+            {
+                const PostingList expected = serialIndex.get_postings(rank);
+                const PostingList actual = parallelIndex.get_postings(rank);
+                if ((serialIndex.get_term(rank) != parallelIndex.get_term(rank)) || (expected.size != actual.size) ||
+                    !std::equal(expected.docIds, expected.docIds + expected.size, actual.docIds) ||
+                    !std::equal(expected.frequencies, expected.frequencies + expected.size, actual.frequencies))
+                    ++failed;
+            }
         }
-        //return b;
-        return fibN;
+
+        for (const auto &filePath : filePaths)
+        {
+            std::remove(filePath.c_str());
+        }
+        std::remove(stopwordFile.c_str());
+        std::remove(indexPaths[0].c_str());
+        std::remove(indexPaths[1].c_str());
+
+        if (failed == 0)
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Parallel index matches the serial index\n");
+        else
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Parallel index differs from the serial index\n");
+    }
+
+    void test_add_files_after_load()
+    {
+        const std::string directory = "/tmp/dis_add_files_" + std::to_string(getpid());
+        std::vector<std::string> filePaths;
+        const std::string stopwordFile = write_test_collection(directory, 4, filePaths);
+        const std::string indexPath = directory + ".index";
+        std::vector<const char *> fileNames;
+        for (const auto &filePath : filePaths)
+        {
+            fileNames.push_back(filePath.c_str());
+        }
+        const std::vector<const char *> loadedFiles(fileNames.begin(), fileNames.end() - 1);
+        const std::vector<const char *> addedFiles = {fileNames.back()};
+
+        const char *queries[] = {"grain wheat", "oil price", "market trade export", "bank rate", "wheat"};
+        const auto query_all = [&queries](SgmlFileCollection &collection)
+        {
+            std::vector<std::vector<DocId>> results;
+            for (const char *query : queries)
+            {
+                results.push_back(collection.get_vector_model().query_documents(azgra::BasicStringView<char>(query)));
+            }
+            return results;
+        };
+
+        SgmlFileCollection rebuilt(fileNames);
+        rebuilt.load_and_preprocess_sgml_files(stopwordFile.c_str());
+        rebuilt.create_term_index_with_vector_model();
+        const auto expected = query_all(rebuilt);
+
+        // Collection with its own model, which is replaced by the load, and a fresh collection without any model.
+        SgmlFileCollection appended(loadedFiles);
+        appended.load_and_preprocess_sgml_files(stopwordFile.c_str());
+        appended.create_term_index_with_vector_model();
+        appended.dump_index(indexPath.c_str());
+        appended.load_index(indexPath.c_str());
+        appended.add_files(addedFiles, stopwordFile.c_str());
+
+        SgmlFileCollection loaded({});
+        loaded.load_index(indexPath.c_str());
+        loaded.add_files(addedFiles, stopwordFile.c_str());
+
+        const bool matches = (query_all(appended) == expected) && (query_all(loaded) == expected);
+
+        for (const auto &filePath : filePaths)
+        {
+            std::remove(filePath.c_str());
+        }
+        std::remove(stopwordFile.c_str());
+        std::remove(indexPath.c_str());
+
+        if (matches)
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Files added after load match the rebuilt model\n");
+        else
+            azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Files added after load differ from the rebuilt model\n");
     }
-}
\ No newline at end of file
+}
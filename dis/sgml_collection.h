@@ -5,69 +5,259 @@
 #include <azgra/collection/set_utilities.h>
 #include <azgra/io/stream/memory_bit_stream.h>
 #include "SgmlFile.h"
+#include "sgml_article_reader.h"
 #include "term_index.h"
+#include "frozen_term_index.h"
 #include "vector_model.h"
+#include "spimi_index_builder.h"
+#include "binary_index.h"
+#include "codec_index.h"
+#include "compressed_term_index.h"
+#include "lazy_compressed_index.h"
+#include "sharded_index.h"
 
 namespace dis
 {
     void test();
 
-    std::vector<size_t> generate_fibonacci_sequence(const size_t n);
 
-
-    struct SizedIndexEntry
+    struct CollectionOptions
     {
-        std::set<DocId> documents;
-        size_t size;
+        /// Memory map the input files and let the articles view the mapped data directly instead of copying every line.
+        bool memoryMappedFiles = false;
 
-        SizedIndexEntry() = default;
+        /// Load and preprocess the input files concurrently. Document ids are the same as with serial loading.
+        bool parallelLoading = false;
 
-        explicit SizedIndexEntry(const std::set<DocumentOccurence> &occurencies)
-        {
-            auto docIds = azgra::collection::select(occurencies.begin(),
-                                                    occurencies.end(),
-                                                    [](const DocumentOccurence &occurence)
-                                                    { return occurence.docId; });
+        /// Upper bound of memory used for a single article by the streaming index construction.
+        size_t streamingMemoryBudget = SgmlArticleReader::DefaultMemoryBudget;
 
-            documents = std::set<DocId>(docIds.begin(), docIds.end());
-            size = documents.size();
-        }
+        /// Number of tokenizer threads of the pipelined ingest, zero means all hardware threads.
+        size_t pipelineWorkerCount = 0;
 
-        bool operator<(const SizedIndexEntry &other) const
-        {
-            return (size < other.size);
-        }
+        /// Capacity of the queues between the pipeline stages.
+        size_t pipelineQueueCapacity = 256;
+
+        /// Record token positions of every term occurence, needed by phrase and proximity queries.
+        bool positionalIndex = false;
+
+        /// Keep the stemmed text of the articles, required by save_preprocessed_documents.
+        bool keepProcessedText = false;
+
+        /// Index disjoint ranges of files concurrently into partial indices, which are concatenated afterwards.
+        bool parallelIndexing = false;
+
+        /// Memory budget of the postings block of the SPIMI index construction.
+        size_t spimiMemoryBudget = SpimiIndexBuilder::DefaultMemoryBudget;
+
+        /// Directory of the temporary SPIMI runs.
+        const char *spimiTempDirectory = "/tmp";
+
+        /// Open compressed indices by their term directory and decode the posting lists when queries first need them.
+        bool lazyCompressedIndex = false;
+
+        /// Upper bound of the decoded posting lists cached by the lazily opened compressed index.
+        size_t postingCacheCapacity = LazyCompressedIndex::DefaultCacheCapacity;
+
+        /// Number of independently coded shards of the compressed index written by dump_compressed_index, shards are
+        /// encoded and decoded concurrently. Zero writes the single stream formats.
+        size_t compressedIndexShardCount = 0;
     };
 
     class SgmlFileCollection
     {
     private:
+        CollectionOptions m_options;
         std::vector<const char *> m_inputFilePaths;
         std::vector<SgmlFile> m_sgmlFiles;
+        /// Mutable index used while the postings are collected.
         TermIndex m_index;
+        /// Index used by queries, dumps and the vector model.
+        FrozenTermIndex m_frozenIndex;
+        /// Binary index opened by load_index, it is queried in place instead of the frozen index.
+        std::unique_ptr<MappedTermIndex> m_mappedIndex;
+        /// Block compressed index, queried with skipping cursors instead of the frozen index.
+        std::unique_ptr<CompressedTermIndex> m_compressedIndex;
+        /// Compressed index opened lazily by load_compressed_index, postings are decoded on demand.
+        std::unique_ptr<LazyCompressedIndex> m_lazyIndex;
+        ArticleMetadataStore m_metadata;
         size_t documentCount = 0;
 
         VectorModel m_vectorModel;
 
+        void load_and_preprocess_sgml_files_parallel(const StopwordSet &stopwords);
+
+        /// Index contiguous file ranges into private partial indices and merge them into the frozen index.
+        void create_term_index_parallel();
+
+        [[nodiscard]] ArticleFilterOptions get_article_filter_options() const;
+
+        /// Build the frozen index from the collected postings and release them.
+        void freeze_index();
+
+        /// Release the frozen, mapped and compressed indices before another index becomes the active one.
+        void release_query_indices();
+
+        /// Make the frozen index the active index, previously loaded indices are released.
+        void install_frozen_index(FrozenTermIndex &&index);
+
+        /// Replace the mapped or compressed index by the frozen index with the same postings, so new documents can be
+        /// merged into it.
+        void materialize_frozen_index();
+
+        /// Call the function with the index answering queries, the mapped index if one was loaded.
+        template<typename Function>
+        decltype(auto) with_query_index(Function &&function) const
+        {
+            if (m_mappedIndex != nullptr)
+                return function(*m_mappedIndex);
+            return function(m_frozenIndex);
+        }
+
+        /// Number of terms of the active index.
+        [[nodiscard]] size_t get_term_count() const
+        {
+            if (m_lazyIndex != nullptr)
+                return m_lazyIndex->size();
+            if (m_compressedIndex != nullptr)
+                return m_compressedIndex->size();
+            return with_query_index([](const auto &index)
+                                    { return index.size(); });
+        }
+
+        /// Whether the active index knows the term frequencies, indices loaded from the compressed files don't.
+        [[nodiscard]] bool has_term_frequencies() const
+        {
+            if (m_lazyIndex != nullptr)
+                return false;
+            return (m_compressedIndex == nullptr) || m_compressedIndex->has_frequencies();
+        }
+
+        /// Call the function with the term, document ids, frequencies and posting count of the terms of the active index
+        /// with ranks in the range. Frequencies are 1 if the index doesn't know them. Ranges may be visited concurrently.
+        template<typename Function>
+        void for_each_posting_list(const size_t rankBegin, const size_t rankEnd, Function &&function) const
+        {
+            if ((m_lazyIndex != nullptr) || (m_compressedIndex != nullptr))
+            {
+                std::vector<azgra::u32> docIds;
+                std::vector<azgra::u32> frequencies;
+                for (size_t rank = rankBegin; rank < rankEnd; ++rank)
+                {
+                    if (m_lazyIndex != nullptr)
+                        m_lazyIndex->decode_postings(rank, docIds);
+                    else
+                        m_compressedIndex->decode_postings(rank, docIds);
+                    if (has_term_frequencies())
+                    {
+                        m_compressedIndex->decode_frequencies(rank, frequencies);
+                    }
+                    else
+                    {
+                        // Compressed index files don't keep the frequencies.
+                        frequencies.assign(docIds.size(), 1);
+                    }
+                    const std::string_view term = (m_lazyIndex != nullptr) ? m_lazyIndex->get_term(rank)
+                                                                           : m_compressedIndex->get_term(rank);
+                    function(term, docIds.data(), frequencies.data(), docIds.size());
+                }
+                return;
+            }
+            with_query_index([rankBegin, rankEnd, &function](const auto &index)
+                             {
+                                 for (size_t rank = rankBegin; rank < rankEnd; ++rank)
+                                 {
+                                     const PostingList postings = index.get_postings(rank);
+                                     function(index.get_term(rank), postings.docIds, postings.frequencies, postings.size);
+                                 }
+                             });
+        }
+
+        /// Call the function with the term, document ids, frequencies and posting count of every term of the active index.
+        template<typename Function>
+        void for_each_posting_list(Function &&function) const
+        {
+            for_each_posting_list(0, get_term_count(), std::forward<Function>(function));
+        }
+
+        /// Write the compressed index in shards encoded concurrently.
+        void dump_sharded_index(const char *filePath, const PostingsCodecType codec) const;
+
+        /// Decode shards of the sharded index concurrently into the block compressed index.
+        void load_sharded_index(const char *filePath);
+
+        /// Replace the active index with the compressed one.
+        void set_compressed_index(std::unique_ptr<CompressedTermIndex> index);
+
+        /// Intersect postings of the query terms with cursors skipping the blocks of the compressed index.
+        /// \return False if some term isn't in the index.
+        bool intersect_compressed_postings(const std::vector<azgra::string::SmartStringView<char>> &keywords,
+                                           const DocumentBitmap *filterBitmap, const bool verbose, std::vector<DocId> &documents) const;
+
     public:
-        explicit SgmlFileCollection(std::vector<const char *> sgmlFilePaths);
+        explicit SgmlFileCollection(std::vector<const char *> sgmlFilePaths, const CollectionOptions &options = {});
 
         void load_and_preprocess_sgml_files(const char *stopwordFile);
 
         void create_term_index_with_vector_model();
 
+        void stream_term_index_with_vector_model(const char *stopwordFile);
+
+        void pipelined_term_index_with_vector_model(const char *stopwordFile);
+
+        /// Build the index of collection which doesn't fit into memory. Articles are streamed one at a time, the postings are
+        /// written in sorted runs of spimiMemoryBudget size and merged into the binary index file mapped by load_index.
+        /// \param stopwordFile File with stopwords.
+        /// \param indexFile Path of the created index.
+        void spimi_term_index(const char *stopwordFile, const char *indexFile);
+
+        /// Append new SGML files to the existing index and vector model. Only articles of the new files are loaded and indexed.
+        /// \param sgmlFilePaths New SGML files.
+        /// \param stopwordFile File with stopwords.
+        void add_files(const std::vector<const char *> &sgmlFilePaths, const char *stopwordFile);
+
+        /// Write the index in the binary format, which can be memory mapped by load_index.
+        /// \param path Index file.
         void dump_index(const char *path);
 
+        /// Memory map binary index file or parse the legacy text dump.
+        /// \param path Index file.
         void load_index(const char *path);
 
         void save_preprocessed_documents(const char *path);
 
-        QueryResult query(azgra::string::SmartStringView<char> &queryText, const bool verbose) const;
+        /// Find documents containing all the query terms.
+        /// \param queryText Query terms.
+        /// \param verbose Print the result.
+        /// \param filter Optional metadata filter, for example `topics:grain AND date>=1987-03`.
+        /// \return Matching documents.
+        QueryResult query(azgra::string::SmartStringView<char> &queryText, const bool verbose, const char *filter = nullptr) const;
 
-        void dump_compressed_index(const char *filePath) const;
+        /// Write document id deltas compressed by the codec. Fibonacci coding is written in the original headerless format,
+        /// other codecs are recorded in the header of the codec index. With compressedIndexShardCount set, terms of any codec
+        /// are written in the sharded index.
+        /// \param filePath Compressed index file.
+        /// \param codec Codec of the document id deltas.
+        void dump_compressed_index(const char *filePath, const PostingsCodecType codec = PostingsCodecType::Fibonacci) const;
 
+        /// Load compressed index of any codec, the format is recognized by the file magic. Postings are kept compressed
+        /// in blocks and queries decode only the blocks they can't skip. With the lazyCompressedIndex option only the term
+        /// directory is read and posting lists are decoded by the queries.
+        /// \param filePath Compressed index file.
         void load_compressed_index(const char *filePath);
 
+        /// Compress postings of the current index into blocks, queries then skip blocks instead of reading whole lists.
+        /// \param codec Codec of the blocks.
+        void compress_index(const PostingsCodecType codec = PostingsCodecType::PFor);
+
         VectorModel &get_vector_model();
+
+        [[nodiscard]] const ArticleMetadataStore &get_metadata() const;
     };
+
+    /// Build the index of generated SGML files serially and with parallel indexing and compare their terms and postings.
+    void test_parallel_term_index();
+
+    /// Load the dumped index of some files, add the remaining ones and compare the vector model with the rebuilt one.
+    void test_add_files_after_load();
 }
@@ -0,0 +1,179 @@
+#include "sgml_tag_scanner.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DIS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace dis
+{
+    typedef size_t (*FindTagOpenFn)(const char *data, size_t from, const size_t size);
+
+    static size_t find_tag_open_scalar(const char *data, size_t from, const size_t size)
+    {
+        for (size_t i = from; i < size; ++i)
+        {
+            if (data[i] == '<')
+                return i;
+        }
+        return size;
+    }
+
+#if DIS_X86_SIMD
+
+    static size_t find_tag_open_sse2(const char *data, size_t from, const size_t size)
+    {
+        const __m128i needle = _mm_set1_epi8('<');
+        size_t i = from;
+        for (; (i + 16) <= size; i += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+            if (mask != 0)
+                return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        return find_tag_open_scalar(data, i, size);
+    }
+
+    __attribute__((target("avx2")))
+    static size_t find_tag_open_avx2(const char *data, size_t from, const size_t size)
+    {
+        const __m256i needle = _mm256_set1_epi8('<');
+        size_t i = from;
+        for (; (i + 32) <= size; i += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+            if (mask != 0)
+                return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        return find_tag_open_sse2(data, i, size);
+    }
+
+#endif
+
+    bool is_scanner_kernel_supported(const SgmlScannerKernel kernel)
+    {
+        switch (kernel)
+        {
+            case SgmlScannerKernel::Auto:
+            case SgmlScannerKernel::Scalar:
+                return true;
+#if DIS_X86_SIMD
+            case SgmlScannerKernel::SSE2:
+                return true;
+            case SgmlScannerKernel::AVX2:
+                return __builtin_cpu_supports("avx2");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    static FindTagOpenFn select_find_function(const SgmlScannerKernel kernel)
+    {
+        always_assert(is_scanner_kernel_supported(kernel) && "Scanner kernel isn't supported by this CPU.");
+#if DIS_X86_SIMD
+        switch (kernel)
+        {
+            case SgmlScannerKernel::Auto:
+                return is_scanner_kernel_supported(SgmlScannerKernel::AVX2) ? find_tag_open_avx2 : find_tag_open_sse2;
+            case SgmlScannerKernel::SSE2:
+                return find_tag_open_sse2;
+            case SgmlScannerKernel::AVX2:
+                return find_tag_open_avx2;
+            default:
+                break;
+        }
+#endif
+        return find_tag_open_scalar;
+    }
+
+    static inline bool tag_at(const char *data, const size_t pos, const size_t size, const char *tag, const size_t tagLen)
+    {
+        return ((pos + tagLen) <= size) && (memcmp(data + pos, tag, tagLen) == 0);
+    }
+
+    static inline bool is_line_start(const char *data, const size_t pos)
+    {
+        return (pos == 0) || (data[pos - 1] == '\n');
+    }
+
+    static inline size_t line_end(const char *data, const size_t pos, const size_t size)
+    {
+        const void *newLine = memchr(data + pos, '\n', size - pos);
+        return (newLine == nullptr) ? size : static_cast<size_t>(static_cast<const char *>(newLine) - data);
+    }
+
+    static inline size_t line_start(const char *data, size_t pos)
+    {
+        while ((pos > 0) && (data[pos - 1] != '\n'))
+            --pos;
+        return pos;
+    }
+
+    std::vector<SgmlArticleRange> scan_sgml_articles(const char *data, const size_t size, const SgmlScannerKernel kernel)
+    {
+        enum class TextState
+        {
+            None,
+            Inside,
+            Done
+        };
+
+        const FindTagOpenFn find_tag_open = select_find_function(kernel);
+        std::vector<SgmlArticleRange> articles;
+        SgmlArticleRange article = {};
+        bool insideArticle = false;
+        TextState textState = TextState::None;
+
+        for (size_t pos = find_tag_open(data, 0, size); pos < size; pos = find_tag_open(data, pos + 1, size))
+        {
+            if (!insideArticle)
+            {
+                if (is_line_start(data, pos) && tag_at(data, pos, size, "<REUTERS ", 9))
+                {
+                    article = {};
+                    article.begin = pos;
+                    insideArticle = true;
+                    textState = TextState::None;
+                }
+                continue;
+            }
+
+            if (is_line_start(data, pos))
+            {
+                if (tag_at(data, pos, size, "</REUTERS>", 10))
+                {
+                    article.end = line_end(data, pos, size);
+                    if (textState == TextState::Inside)
+                        article.textEnd = article.end;
+                    articles.push_back(article);
+                    insideArticle = false;
+                    pos = article.end;
+                    continue;
+                }
+                if ((textState == TextState::None) && tag_at(data, pos, size, "<TEXT", 5))
+                {
+                    // Rest of the <TEXT line is not part of the text section.
+                    const size_t textLineEnd = line_end(data, pos, size);
+                    article.textBegin = (textLineEnd < size) ? (textLineEnd + 1) : size;
+                    article.textEnd = article.textBegin;
+                    textState = TextState::Inside;
+                    pos = textLineEnd;
+                    continue;
+                }
+            }
+
+            if ((textState == TextState::Inside) && tag_at(data, pos, size, "</TEXT>", 7))
+            {
+                article.textEnd = line_start(data, pos);
+                textState = TextState::Done;
+            }
+        }
+
+        always_assert(!insideArticle && "Missing closing of article");
+        return articles;
+    }
+}
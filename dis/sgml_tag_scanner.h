@@ -0,0 +1,39 @@
+#pragma once
+
+#include <azgra/azgra.h>
+#include <vector>
+
+namespace dis
+{
+    /// Byte ranges of one Reuters article inside the raw SGML data.
+    struct SgmlArticleRange
+    {
+        /// Start of the `<REUTERS ` line.
+        size_t begin{};
+        /// End of the `</REUTERS>` line, excluding the new line character.
+        size_t end{};
+        /// Start of the first line after the `<TEXT` line.
+        size_t textBegin{};
+        /// Start of the line which contains `</TEXT>`.
+        size_t textEnd{};
+    };
+
+    enum class SgmlScannerKernel
+    {
+        Auto,
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    /// Find article and TEXT section byte ranges in single pass over the raw SGML bytes. Tags are matched with the same rules
+    /// as the line based parsing: `<REUTERS `, `</REUTERS>` and `<TEXT` at the line start and `</TEXT>` anywhere in the line.
+    /// \param data Raw SGML file data.
+    /// \param size Size of the data.
+    /// \param kernel Vectorized kernel used to find tag candidates, Auto selects the best one supported by the CPU.
+    /// \return Article ranges in file order.
+    std::vector<SgmlArticleRange> scan_sgml_articles(const char *data, const size_t size,
+                                                     const SgmlScannerKernel kernel = SgmlScannerKernel::Auto);
+
+    bool is_scanner_kernel_supported(const SgmlScannerKernel kernel);
+}
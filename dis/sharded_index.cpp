@@ -0,0 +1,103 @@
+#include "sharded_index.h"
+#include "binary_io.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace dis
+{
+    bool is_sharded_index(const char *path)
+    {
+        return file_starts_with_magic(path, ShardedIndexMagic);
+    }
+
+    ShardedIndexWriter::ShardedIndexWriter(const PostingsCodecType codec, const size_t shardCount, const size_t termCount) :
+            m_codec(create_postings_codec(codec)), m_termCount(termCount)
+    {
+        m_shards.resize(std::max<size_t>(1, std::min(shardCount, termCount)));
+    }
+
+    void ShardedIndexWriter::add_term(const size_t shard, const std::string_view &term, const azgra::u32 *docIds, const size_t count)
+    {
+        Shard &target = m_shards[shard];
+        target.directory.add_term(term, append_coded_term(*m_codec, term, docIds, count, target.deltas, target.buffer), count);
+        ++target.termCount;
+    }
+
+    void ShardedIndexWriter::write(const char *path) const
+    {
+        ShardedIndexHeader header{};
+        memcpy(header.magic, ShardedIndexMagic, sizeof(ShardedIndexMagic));
+        header.version = ShardedIndexVersion;
+        header.codec = m_codec->get_type();
+        header.shardCount = static_cast<azgra::u32>(m_shards.size());
+
+        std::vector<ShardDirectoryEntry> shardDirectory(m_shards.size());
+        TermDirectoryWriter termDirectory;
+        azgra::u64 offset = sizeof(ShardedIndexHeader) + (shardDirectory.size() * sizeof(ShardDirectoryEntry));
+        for (size_t shard = 0; shard < m_shards.size(); ++shard)
+        {
+            shardDirectory[shard].offset = offset;
+            shardDirectory[shard].size = m_shards[shard].buffer.size();
+            shardDirectory[shard].termCount = m_shards[shard].termCount;
+            termDirectory.append(m_shards[shard].directory, offset);
+            header.termCount += m_shards[shard].termCount;
+            offset += m_shards[shard].buffer.size();
+        }
+        std::vector<azgra::byte> trailer;
+        termDirectory.append_to(trailer, offset);
+
+        std::ofstream stream(path, std::ios::out | std::ios::binary);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(shardDirectory.data()), shardDirectory.size() * sizeof(ShardDirectoryEntry));
+        for (const Shard &shard : m_shards)
+        {
+            stream.write(reinterpret_cast<const char *>(shard.buffer.data()), shard.buffer.size());
+        }
+        stream.write(reinterpret_cast<const char *>(trailer.data()), trailer.size());
+        always_assert(stream.good() && "Failed to write sharded index.");
+    }
+
+    IndexShardReader::IndexShardReader(const PostingsCodec &codec, const azgra::byte *data, const ShardDirectoryEntry &shard) :
+            m_codec(codec), m_data(data), m_offset(shard.offset), m_termCount(shard.termCount)
+    {
+    }
+
+    bool IndexShardReader::read_next()
+    {
+        if (m_termIndex == m_termCount)
+            return false;
+        ++m_termIndex;
+        read_coded_term(m_codec, m_data, m_offset, m_term, m_docIds);
+        return true;
+    }
+
+    ShardedIndexReader::ShardedIndexReader(const char *path)
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+        always_assert(stream.is_open() && "Failed to open sharded index.");
+        const auto fileSize = static_cast<size_t>(stream.tellg());
+        always_assert(fileSize >= sizeof(ShardedIndexHeader) && "File is too small to be a sharded index.");
+        // Decoders may read past the last shard.
+        m_buffer.resize(fileSize + PostingsCodec::DecodePadding, 0);
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(m_buffer.data()), fileSize);
+
+        m_header = reinterpret_cast<const ShardedIndexHeader *>(m_buffer.data());
+        always_assert(memcmp(m_header->magic, ShardedIndexMagic, sizeof(ShardedIndexMagic)) == 0 && "Not a sharded index.");
+        always_assert(m_header->version == ShardedIndexVersion && "Unsupported sharded index version.");
+        always_assert((sizeof(ShardedIndexHeader) + (m_header->shardCount * sizeof(ShardDirectoryEntry))) <= fileSize &&
+                      "Sharded index is truncated.");
+        m_codec = create_postings_codec(m_header->codec);
+        m_shards = reinterpret_cast<const ShardDirectoryEntry *>(m_buffer.data() + sizeof(ShardedIndexHeader));
+        for (size_t shard = 0; shard < m_header->shardCount; ++shard)
+        {
+            always_assert((m_shards[shard].offset + m_shards[shard].size) <= fileSize && "Sharded index is truncated.");
+        }
+    }
+
+    IndexShardReader ShardedIndexReader::open_shard(const size_t shard) const
+    {
+        return IndexShardReader(*m_codec, m_buffer.data(), m_shards[shard]);
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include "codec_index.h"
+#include "term_directory.h"
+
+namespace dis
+{
+    /// Header of the sharded compressed index. Header is followed by the shard directory and the shards, every shard is
+    /// a run of consecutive terms coded independently in the term records of the codec index, so the shards can be encoded
+    /// and decoded concurrently. The shards are followed by the term directory.
+    struct ShardedIndexHeader
+    {
+        char magic[4];
+        azgra::u32 version;
+        PostingsCodecType codec;
+        azgra::u32 shardCount;
+        azgra::u64 termCount;
+    };
+    static_assert(sizeof(ShardedIndexHeader) == 24, "Sharded index header must keep its size.");
+
+    struct ShardDirectoryEntry
+    {
+        /// Byte offset of the first term record of the shard.
+        azgra::u64 offset;
+        /// Byte size of the shard.
+        azgra::u64 size;
+        azgra::u64 termCount;
+    };
+
+    constexpr char ShardedIndexMagic[4] = {'T', 'D', 'A', 'S'};
+    constexpr azgra::u32 ShardedIndexVersion = 2;
+
+    /// Check whether the file starts with the sharded index magic.
+    bool is_sharded_index(const char *path);
+
+    /// Builds the shards in memory, different shards can be filled concurrently.
+    class ShardedIndexWriter
+    {
+    private:
+        struct Shard
+        {
+            std::vector<azgra::byte> buffer;
+            std::vector<azgra::u32> deltas;
+            TermDirectoryWriter directory;
+            azgra::u64 termCount = 0;
+        };
+
+        std::unique_ptr<PostingsCodec> m_codec;
+        std::vector<Shard> m_shards;
+        size_t m_termCount;
+
+    public:
+        /// Split the terms into shards of consecutive ranks.
+        /// \param codec Codec of the document id deltas.
+        /// \param shardCount Requested number of shards, there is at most one shard per term.
+        /// \param termCount Number of terms of the index.
+        ShardedIndexWriter(const PostingsCodecType codec, const size_t shardCount, const size_t termCount);
+
+        [[nodiscard]] size_t get_shard_count() const
+        { return m_shards.size(); }
+
+        /// Rank of the first term of the shard.
+        [[nodiscard]] size_t get_shard_begin(const size_t shard) const
+        { return (shard * m_termCount) / m_shards.size(); }
+
+        /// Rank after the last term of the shard.
+        [[nodiscard]] size_t get_shard_end(const size_t shard) const
+        { return get_shard_begin(shard + 1); }
+
+        /// Append the term with its ascending document ids to the shard, terms of the shard must be added in rank order.
+        void add_term(const size_t shard, const std::string_view &term, const azgra::u32 *docIds, const size_t count);
+
+        /// Write the header, shard directory, shards and the term directory.
+        void write(const char *path) const;
+    };
+
+    /// Reads terms of one shard one by one.
+    class IndexShardReader
+    {
+    private:
+        const PostingsCodec &m_codec;
+        const azgra::byte *m_data;
+        size_t m_offset;
+        size_t m_termCount;
+        size_t m_termIndex = 0;
+        std::string_view m_term;
+        std::vector<azgra::u32> m_docIds;
+
+    public:
+        IndexShardReader(const PostingsCodec &codec, const azgra::byte *data, const ShardDirectoryEntry &shard);
+
+        /// Decode the next term of the shard.
+        /// \return False if all terms of the shard were read.
+        bool read_next();
+
+        /// Term read last, valid while the index reader exists.
+        [[nodiscard]] std::string_view get_term() const
+        { return m_term; }
+
+        [[nodiscard]] const std::vector<azgra::u32> &get_doc_ids() const
+        { return m_docIds; }
+    };
+
+    /// Reads the whole sharded index, shards are opened independently and can be decoded concurrently.
+    class ShardedIndexReader
+    {
+    private:
+        std::vector<azgra::byte> m_buffer;
+        std::unique_ptr<PostingsCodec> m_codec;
+        const ShardedIndexHeader *m_header = nullptr;
+        const ShardDirectoryEntry *m_shards = nullptr;
+
+    public:
+        explicit ShardedIndexReader(const char *path);
+
+        [[nodiscard]] IndexShardReader open_shard(const size_t shard) const;
+
+        [[nodiscard]] const PostingsCodec &get_codec() const
+        { return *m_codec; }
+
+        [[nodiscard]] size_t get_shard_count() const
+        { return m_header->shardCount; }
+
+        [[nodiscard]] size_t get_term_count() const
+        { return m_header->termCount; }
+    };
+}
@@ -0,0 +1,183 @@
+#include "spimi_index_builder.h"
+#include "binary_index.h"
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <unistd.h>
+
+namespace dis
+{
+    SpimiIndexBuilder::RunReader::RunReader(const std::string &path) : m_stream(path, std::ios::in | std::ios::binary)
+    {
+        always_assert(m_stream.is_open() && "Failed to open SPIMI run.");
+    }
+
+    bool SpimiIndexBuilder::RunReader::read_next()
+    {
+        azgra::u32 termLength = 0;
+        azgra::u32 postingCount = 0;
+        if (!m_stream.read(reinterpret_cast<char *>(&termLength), sizeof(termLength)))
+            return false;
+
+        m_term.resize(termLength);
+        m_stream.read(m_term.data(), termLength);
+        m_stream.read(reinterpret_cast<char *>(&postingCount), sizeof(postingCount));
+        m_postings.resize(postingCount);
+        m_stream.read(reinterpret_cast<char *>(m_postings.data()), postingCount * sizeof(SpimiPosting));
+        always_assert(m_stream.good() && "Truncated SPIMI run.");
+        return true;
+    }
+
+    const std::string &SpimiIndexBuilder::RunReader::get_term() const
+    {
+        return m_term;
+    }
+
+    const std::vector<SpimiIndexBuilder::SpimiPosting> &SpimiIndexBuilder::RunReader::get_postings() const
+    {
+        return m_postings;
+    }
+
+    SpimiIndexBuilder::SpimiIndexBuilder(std::shared_ptr<TermDictionary> dictionary, const size_t memoryBudget,
+                                         std::string tempDirectory) :
+            m_dictionary(std::move(dictionary)), m_memoryBudget(memoryBudget), m_tempDirectory(std::move(tempDirectory))
+    {
+        always_assert(m_dictionary != nullptr);
+    }
+
+    SpimiIndexBuilder::~SpimiIndexBuilder()
+    {
+        for (const auto &runPath : m_runPaths)
+        {
+            std::remove(runPath.c_str());
+        }
+    }
+
+    void SpimiIndexBuilder::add_article(const DocId docId, const std::vector<TermFrequency> &termFrequencies)
+    {
+        always_assert(docId > m_lastDocId && "Articles must be added in the order of document ids.");
+        always_assert(docId <= std::numeric_limits<azgra::u32>::max());
+        m_lastDocId = docId;
+
+        if (m_blockPostings.size() < m_dictionary->size())
+        {
+            // Slot of every known term, its size isn't part of the budget as it is bound by the vocabulary.
+            m_blockPostings.resize(m_dictionary->size());
+        }
+        for (const TermFrequency &termFrequency : termFrequencies)
+        {
+            auto &postings = m_blockPostings[termFrequency.termId];
+            const size_t capacity = postings.capacity();
+            if (postings.empty())
+            {
+                m_blockTerms.push_back(termFrequency.termId);
+                m_blockBytes += sizeof(TermId);
+            }
+            postings.push_back(SpimiPosting{static_cast<azgra::u32>(docId), termFrequency.frequency});
+            m_blockBytes += (postings.capacity() - capacity) * sizeof(SpimiPosting);
+        }
+        m_postingCount += termFrequencies.size();
+
+        if (m_blockBytes >= m_memoryBudget)
+            write_block();
+    }
+
+    void SpimiIndexBuilder::write_block()
+    {
+        if (m_blockTerms.empty())
+            return;
+
+        std::sort(m_blockTerms.begin(), m_blockTerms.end(), [this](const TermId a, const TermId b)
+        {
+            return m_dictionary->get_term(a) < m_dictionary->get_term(b);
+        });
+
+        const std::string runPath = m_tempDirectory + "/spimi_" + std::to_string(getpid()) + "_" +
+                                    std::to_string(reinterpret_cast<uintptr_t>(this)) + "_" + std::to_string(m_runCount) + ".run";
+        std::ofstream run(runPath, std::ios::out | std::ios::binary);
+        always_assert(run.is_open() && "Failed to create SPIMI run.");
+        for (const TermId termId : m_blockTerms)
+        {
+            const std::string_view term = m_dictionary->get_term(termId);
+            const auto termLength = static_cast<azgra::u32>(term.length());
+            auto &postings = m_blockPostings[termId];
+            const auto postingCount = static_cast<azgra::u32>(postings.size());
+            run.write(reinterpret_cast<const char *>(&termLength), sizeof(termLength));
+            run.write(term.data(), termLength);
+            run.write(reinterpret_cast<const char *>(&postingCount), sizeof(postingCount));
+            run.write(reinterpret_cast<const char *>(postings.data()), postingCount * sizeof(SpimiPosting));
+            std::vector<SpimiPosting>().swap(postings);
+        }
+        always_assert(run.good() && "Failed to write SPIMI run.");
+        m_runPaths.push_back(runPath);
+        ++m_runCount;
+
+        m_blockTerms.clear();
+        m_blockTerms.shrink_to_fit();
+        m_blockBytes = 0;
+    }
+
+    size_t SpimiIndexBuilder::write_index(const char *indexFile)
+    {
+        write_block();
+
+        std::vector<std::unique_ptr<RunReader>> runs;
+        // Heap of the current term of every run, runs with equal terms are popped in the order of document ids.
+        typedef std::pair<std::string, size_t> HeapEntry;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap;
+        for (const auto &runPath : m_runPaths)
+        {
+            runs.push_back(std::make_unique<RunReader>(runPath));
+            if (runs.back()->read_next())
+                heap.emplace(runs.back()->get_term(), runs.size() - 1);
+        }
+
+        // Postings of a term are streamed run record by run record, only one record is split at a time.
+        BinaryIndexWriter index(indexFile);
+        std::vector<azgra::u32> docIds;
+        std::vector<azgra::u32> frequencies;
+        size_t termCount = 0;
+        while (!heap.empty())
+        {
+            const std::string term = heap.top().first;
+            index.begin_term(term);
+            while (!heap.empty() && (heap.top().first == term))
+            {
+                RunReader &run = *runs[heap.top().second];
+                const size_t runIndex = heap.top().second;
+                heap.pop();
+                docIds.clear();
+                frequencies.clear();
+                for (const auto &[docId, frequency] : run.get_postings())
+                {
+                    docIds.push_back(docId);
+                    frequencies.push_back(frequency);
+                }
+                index.append_postings(docIds.data(), frequencies.data(), docIds.size());
+                if (run.read_next())
+                    heap.emplace(run.get_term(), runIndex);
+            }
+            index.end_term();
+            ++termCount;
+        }
+        index.finish();
+
+        runs.clear();
+        for (const auto &runPath : m_runPaths)
+        {
+            std::remove(runPath.c_str());
+        }
+        m_runPaths.clear();
+        return termCount;
+    }
+
+    size_t SpimiIndexBuilder::get_run_count() const
+    {
+        return m_runCount;
+    }
+
+    size_t SpimiIndexBuilder::get_posting_count() const
+    {
+        return m_postingCount;
+    }
+}
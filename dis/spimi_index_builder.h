@@ -0,0 +1,93 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "article_term_counter.h"
+#include "term_index.h"
+
+namespace dis
+{
+    /// Single pass in memory indexing of collections larger than the memory. Postings are collected in a block until the memory
+    /// budget is reached, then the block is written to a run file sorted by term. The runs are merged into the final index file.
+    /// Articles must be added in the order of their document ids.
+    class SpimiIndexBuilder
+    {
+    private:
+        /// Posting as it is stored in the run files, without any padding bytes.
+        struct SpimiPosting
+        {
+            azgra::u32 docId;
+            azgra::u32 frequency;
+        };
+        static_assert(sizeof(SpimiPosting) == 8, "Run file postings must not contain padding.");
+
+        /// Sequential reader of one run file.
+        class RunReader
+        {
+        private:
+            std::ifstream m_stream;
+            std::string m_term;
+            std::vector<SpimiPosting> m_postings;
+
+        public:
+            explicit RunReader(const std::string &path);
+
+            /// Read the next term record of the run.
+            /// \return False if the run is exhausted.
+            bool read_next();
+
+            [[nodiscard]] const std::string &get_term() const;
+
+            [[nodiscard]] const std::vector<SpimiPosting> &get_postings() const;
+        };
+
+        std::shared_ptr<TermDictionary> m_dictionary;
+        size_t m_memoryBudget;
+        std::string m_tempDirectory;
+        std::vector<std::string> m_runPaths;
+
+        /// Postings of the current block indexed by TermId.
+        std::vector<std::vector<SpimiPosting>> m_blockPostings;
+        /// TermIds with postings in the current block.
+        std::vector<TermId> m_blockTerms;
+        size_t m_blockBytes = 0;
+        size_t m_postingCount = 0;
+        size_t m_runCount = 0;
+        DocId m_lastDocId = 0;
+
+        void write_block();
+
+    public:
+        static constexpr size_t DefaultMemoryBudget = 256 * 1024 * 1024;
+
+        /// Create builder writing its runs into temporary directory.
+        /// \param dictionary Dictionary of the TermIds of the added articles.
+        /// \param memoryBudget Upper bound of the memory used by the postings of one block.
+        /// \param tempDirectory Existing directory for the run files.
+        SpimiIndexBuilder(std::shared_ptr<TermDictionary> dictionary, const size_t memoryBudget = DefaultMemoryBudget,
+                          std::string tempDirectory = "/tmp");
+
+        ~SpimiIndexBuilder();
+
+        SpimiIndexBuilder(const SpimiIndexBuilder &) = delete;
+
+        SpimiIndexBuilder &operator=(const SpimiIndexBuilder &) = delete;
+
+        /// Add postings of the article, block is written out when it exceeds the memory budget.
+        /// \param docId Document id, greater than the ids of the previous articles.
+        /// \param termFrequencies Terms of the article.
+        void add_article(const DocId docId, const std::vector<TermFrequency> &termFrequencies);
+
+        /// Merge all runs into the binary index file and remove the runs.
+        /// \param indexFile Path of the final index.
+        /// \return Number of terms in the index.
+        size_t write_index(const char *indexFile);
+
+        /// Number of runs written so far.
+        [[nodiscard]] size_t get_run_count() const;
+
+        [[nodiscard]] size_t get_posting_count() const;
+    };
+}
@@ -0,0 +1,75 @@
+#include "stem_cache.h"
+#include <mutex>
+#include "hash.h"
+#include "inplace_stemmer.h"
+
+namespace dis
+{
+    StemCache::StemCache(const size_t maxEntries)
+    {
+        m_maxShardEntries = std::max<size_t>(1, maxEntries / ShardCount);
+    }
+
+    std::string_view StemCache::stem(const char *word, const size_t length, std::string &stemBuffer)
+    {
+        const std::string_view key(word, length);
+        Shard &shard = m_shards[fnv1a_hash(word, length) % ShardCount];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            const auto it = shard.stems.find(key);
+            if (it != shard.stems.end())
+            {
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+
+        // Stem is computed outside of the lock, another thread may insert the same word meanwhile.
+        stemBuffer.assign(word, length);
+        stemBuffer.resize(stem_in_place(stemBuffer.data(), length));
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const auto it = shard.stems.find(key);
+        if (it != shard.stems.end())
+            return it->second;
+        if (shard.stems.size() >= m_maxShardEntries)
+            return stemBuffer;
+
+        const std::string &storedWord = shard.storage.emplace_back(word, length);
+        const std::string &storedStem = shard.storage.emplace_back(stemBuffer);
+        shard.stems.emplace(storedWord, storedStem);
+        return storedStem;
+    }
+
+    StemCacheStatistics StemCache::get_statistics() const
+    {
+        StemCacheStatistics statistics = {};
+        for (const Shard &shard : m_shards)
+        {
+            statistics.hits += shard.hits.load(std::memory_order_relaxed);
+            statistics.misses += shard.misses.load(std::memory_order_relaxed);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            statistics.entries += shard.stems.size();
+        }
+        return statistics;
+    }
+
+    void StemCache::clear()
+    {
+        for (Shard &shard : m_shards)
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.stems.clear();
+            shard.storage.clear();
+            shard.hits = 0;
+            shard.misses = 0;
+        }
+    }
+
+    StemCache &StemCache::global()
+    {
+        static StemCache cache;
+        return cache;
+    }
+}
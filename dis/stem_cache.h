@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    struct StemCacheStatistics
+    {
+        azgra::u64 hits = 0;
+        azgra::u64 misses = 0;
+        size_t entries = 0;
+
+        [[nodiscard]] double hit_rate() const
+        {
+            const azgra::u64 lookups = hits + misses;
+            return (lookups == 0) ? 0.0 : (static_cast<double>(hits) / static_cast<double>(lookups));
+        }
+    };
+
+    /// Thread-safe cache of Porter stems keyed by the surface form. The map is split into shards with their own
+    /// reader-writer lock, so concurrent tokenizers mostly take shared locks of different shards.
+    class StemCache
+    {
+    private:
+        static constexpr size_t ShardCount = 64;
+
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            /// Views into the strings of storage, deque never moves its elements.
+            std::unordered_map<std::string_view, std::string_view> stems;
+            std::deque<std::string> storage;
+            std::atomic<azgra::u64> hits{0};
+            std::atomic<azgra::u64> misses{0};
+        };
+
+        size_t m_maxShardEntries;
+        std::array<Shard, ShardCount> m_shards;
+
+    public:
+        static constexpr size_t DefaultMaxEntries = 1u << 20u;
+
+        /// Create cache.
+        /// \param maxEntries Upper bound of cached words, stems of other words are computed but not stored.
+        explicit StemCache(const size_t maxEntries = DefaultMaxEntries);
+
+        StemCache(const StemCache &) = delete;
+
+        StemCache &operator=(const StemCache &) = delete;
+
+        /// Get stem of the word, the word is stemmed only when it isn't cached.
+        /// \param word Word bytes.
+        /// \param length Length of the word.
+        /// \param stemBuffer Storage of the stem when it can't be cached.
+        /// \return Stem view, valid until the cache is cleared or stemBuffer is changed.
+        std::string_view stem(const char *word, const size_t length, std::string &stemBuffer);
+
+        [[nodiscard]] StemCacheStatistics get_statistics() const;
+
+        /// Remove all entries and reset the counters. Must not run concurrently with stem.
+        void clear();
+
+        /// Cache shared by the document preprocessing and query parsing.
+        static StemCache &global();
+    };
+
+    /// Stem the word through the global stem cache.
+    inline std::string_view cached_stem_word(const char *word, const size_t length, std::string &stemBuffer)
+    {
+        return StemCache::global().stem(word, length, stemBuffer);
+    }
+}
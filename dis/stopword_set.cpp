@@ -0,0 +1,56 @@
+#include "stopword_set.h"
+#include <cstring>
+#include <azgra/io/text_file_functions.h>
+#include "hash.h"
+
+namespace dis
+{
+    StopwordSet::StopwordSet(const std::vector<std::string> &stopwords)
+    {
+        // Load factor is kept under one half so the probe sequences stay short.
+        m_slots.resize(next_power_of_two(std::max<size_t>(16, stopwords.size() * 2)));
+        for (const auto &stopword : stopwords)
+        {
+            if (!stopword.empty())
+            {
+                insert(stopword.c_str(), stopword.length());
+            }
+        }
+    }
+
+    StopwordSet StopwordSet::load(const char *fileName)
+    {
+        return StopwordSet(azgra::io::read_lines(fileName));
+    }
+
+    void StopwordSet::insert(const char *word, const size_t length)
+    {
+        if (contains(word, length))
+            return;
+
+        const size_t mask = m_slots.size() - 1;
+        size_t slot = fnv1a_hash(word, length) & mask;
+        while (m_slots[slot].used)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = {static_cast<azgra::u32>(m_words.length()), static_cast<azgra::u32>(length), true};
+        m_words.append(word, length);
+        ++m_count;
+    }
+
+    bool StopwordSet::contains(const char *word, const size_t length) const
+    {
+        if (m_slots.empty())
+            return false;
+
+        const size_t mask = m_slots.size() - 1;
+        for (size_t slot = fnv1a_hash(word, length) & mask; m_slots[slot].used; slot = (slot + 1) & mask)
+        {
+            const Slot &s = m_slots[slot];
+            if ((s.length == length) && (memcmp(m_words.data() + s.offset, word, length) == 0))
+                return true;
+        }
+        return false;
+    }
+}
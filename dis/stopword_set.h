@@ -0,0 +1,39 @@
+#pragma once
+
+#include <azgra/azgra.h>
+#include <string>
+#include <vector>
+
+namespace dis
+{
+    /// Open addressing hash set of stopwords. Membership is tested directly on the token bytes.
+    class StopwordSet
+    {
+    private:
+        struct Slot
+        {
+            azgra::u32 offset{};
+            azgra::u32 length{};
+            bool used{};
+        };
+
+        std::string m_words;
+        std::vector<Slot> m_slots;
+        size_t m_count = 0;
+
+        void insert(const char *word, const size_t length);
+
+    public:
+        StopwordSet() = default;
+
+        explicit StopwordSet(const std::vector<std::string> &stopwords);
+
+        /// Load stopwords from file with one stopword per line.
+        static StopwordSet load(const char *fileName);
+
+        [[nodiscard]] bool contains(const char *word, const size_t length) const;
+
+        [[nodiscard]] size_t size() const
+        { return m_count; }
+    };
+}
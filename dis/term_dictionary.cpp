@@ -0,0 +1,122 @@
+#include "term_dictionary.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include "hash.h"
+
+namespace dis
+{
+    size_t TermDictionary::find_slot(const char *term, const size_t length, const azgra::u64 hash) const
+    {
+        const size_t mask = m_slots.size() - 1;
+        size_t slot = hash & mask;
+        while (m_slots[slot] != InvalidTermId)
+        {
+            const TermEntry &entry = m_entries[m_slots[slot]];
+            if ((entry.hash == hash) && (entry.length == length) && (memcmp(m_termData.data() + entry.offset, term, length) == 0))
+                break;
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void TermDictionary::rehash(const size_t slotCount)
+    {
+        m_slots.assign(slotCount, InvalidTermId);
+        const size_t mask = slotCount - 1;
+        for (TermId termId = 0; termId < m_entries.size(); ++termId)
+        {
+            size_t slot = m_entries[termId].hash & mask;
+            while (m_slots[slot] != InvalidTermId)
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_slots[slot] = termId;
+        }
+    }
+
+    TermId TermDictionary::find_unlocked(const char *term, const size_t length, const azgra::u64 hash) const
+    {
+        if (m_slots.empty())
+            return InvalidTermId;
+        return m_slots[find_slot(term, length, hash)];
+    }
+
+    std::string_view TermDictionary::get_term_unlocked(const TermId termId) const
+    {
+        const TermEntry &entry = m_entries[termId];
+        return std::string_view(m_termData.data() + entry.offset, entry.length);
+    }
+
+    TermId TermDictionary::intern(const char *term, const size_t length)
+    {
+        const azgra::u64 hash = fnv1a_hash(term, length);
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            const TermId termId = find_unlocked(term, length, hash);
+            if (termId != InvalidTermId)
+                return termId;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        // Load factor is kept under one half so the probe sequences stay short.
+        if (((m_entries.size() + 1) * 2) > m_slots.size())
+        {
+            rehash(next_power_of_two(std::max<size_t>(1024, (m_entries.size() + 1) * 4)));
+        }
+
+        // Other thread could add the term between the locks.
+        const size_t slot = find_slot(term, length, hash);
+        if (m_slots[slot] != InvalidTermId)
+            return m_slots[slot];
+
+        always_assert(m_entries.size() < InvalidTermId && m_termData.length() + length <= std::numeric_limits<azgra::u32>::max());
+        const auto termId = static_cast<TermId>(m_entries.size());
+        m_entries.push_back({static_cast<azgra::u32>(m_termData.length()), static_cast<azgra::u32>(length), hash});
+        m_termData.append(term, length);
+        m_slots[slot] = termId;
+        return termId;
+    }
+
+    TermId TermDictionary::find(const char *term, const size_t length) const
+    {
+        const azgra::u64 hash = fnv1a_hash(term, length);
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return find_unlocked(term, length, hash);
+    }
+
+    std::string_view TermDictionary::get_term(const TermId termId) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return get_term_unlocked(termId);
+    }
+
+    std::vector<TermId> TermDictionary::get_sorted_term_ids() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        std::vector<TermId> termIds(m_entries.size());
+        for (TermId termId = 0; termId < termIds.size(); ++termId)
+        {
+            termIds[termId] = termId;
+        }
+        std::sort(termIds.begin(), termIds.end(), [this](const TermId a, const TermId b)
+        {
+            return get_term_unlocked(a) < get_term_unlocked(b);
+        });
+        return termIds;
+    }
+
+    size_t TermDictionary::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    void TermDictionary::clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_termData.clear();
+        m_entries.clear();
+        m_slots.clear();
+    }
+}
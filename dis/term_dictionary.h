@@ -0,0 +1,68 @@
+#pragma once
+
+#include <azgra/azgra.h>
+#include <limits>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dis
+{
+    typedef azgra::u32 TermId;
+
+    /// Interning dictionary mapping every stemmed term to a dense TermId. Ids are assigned in the order of first occurence
+    /// and never change, term bytes are stored once in a single buffer. All methods are thread-safe, lookups of known terms
+    /// take only the shared lock.
+    class TermDictionary
+    {
+    private:
+        struct TermEntry
+        {
+            azgra::u32 offset{};
+            azgra::u32 length{};
+            azgra::u64 hash{};
+        };
+
+        std::string m_termData;
+        std::vector<TermEntry> m_entries;
+        std::vector<TermId> m_slots;
+        mutable std::shared_mutex m_mutex;
+
+        [[nodiscard]] size_t find_slot(const char *term, const size_t length, const azgra::u64 hash) const;
+
+        void rehash(const size_t slotCount);
+
+        [[nodiscard]] TermId find_unlocked(const char *term, const size_t length, const azgra::u64 hash) const;
+
+        [[nodiscard]] std::string_view get_term_unlocked(const TermId termId) const;
+
+    public:
+        static constexpr TermId InvalidTermId = std::numeric_limits<TermId>::max();
+
+        TermDictionary() = default;
+
+        /// Get id of the term, the term is added if it isn't in the dictionary yet.
+        TermId intern(const char *term, const size_t length);
+
+        TermId intern(const std::string_view &term)
+        { return intern(term.data(), term.length()); }
+
+        /// Get id of the term.
+        /// \return TermId or InvalidTermId if the term isn't in the dictionary.
+        [[nodiscard]] TermId find(const char *term, const size_t length) const;
+
+        [[nodiscard]] TermId find(const std::string_view &term) const
+        { return find(term.data(), term.length()); }
+
+        /// Get term of the id. View is valid until next term is added, so it must not be used while other threads intern terms.
+        [[nodiscard]] std::string_view get_term(const TermId termId) const;
+
+        /// Get all term ids ordered by their terms.
+        [[nodiscard]] std::vector<TermId> get_sorted_term_ids() const;
+
+        [[nodiscard]] size_t size() const;
+
+        void clear();
+    };
+}
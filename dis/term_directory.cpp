@@ -0,0 +1,95 @@
+#include "term_directory.h"
+#include "binary_io.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace dis
+{
+    void TermDirectoryWriter::add_term(const std::string_view &term, const azgra::u64 postingsOffset, const size_t postingCount)
+    {
+        always_assert(postingCount <= std::numeric_limits<azgra::u32>::max());
+        append_value(m_entries, static_cast<azgra::u32>(term.length()));
+        m_entries.insert(m_entries.end(), term.begin(), term.end());
+        append_value(m_entries, postingsOffset);
+        append_value(m_entries, static_cast<azgra::u32>(postingCount));
+        ++m_termCount;
+    }
+
+    void TermDirectoryWriter::append(const TermDirectoryWriter &other, const azgra::u64 offsetBase)
+    {
+        const char *entries = reinterpret_cast<const char *>(other.m_entries.data());
+        size_t offset = 0;
+        while (offset < other.m_entries.size())
+        {
+            const auto termLength = read_value<azgra::u32>(entries, offset);
+            const std::string_view term(entries + offset, termLength);
+            offset += termLength;
+            const auto postingsOffset = read_value<azgra::u64>(entries, offset);
+            const auto postingCount = read_value<azgra::u32>(entries, offset);
+            add_term(term, offsetBase + postingsOffset, postingCount);
+        }
+    }
+
+    void TermDirectoryWriter::append_to(std::vector<azgra::byte> &buffer, const azgra::u64 bufferOffset) const
+    {
+        TermDirectoryFooter footer{};
+        footer.directoryOffset = bufferOffset + buffer.size();
+        footer.termCount = m_termCount;
+        memcpy(footer.magic, TermDirectoryMagic, sizeof(TermDirectoryMagic));
+        footer.version = TermDirectoryVersion;
+
+        buffer.insert(buffer.end(), m_entries.begin(), m_entries.end());
+        append_value(buffer, footer);
+    }
+
+    /// Read the footer from its bytes and validate it against the size of the file.
+    static bool read_footer(const char *footerBytes, const size_t fileSize, TermDirectoryFooter &footer)
+    {
+        memcpy(&footer, footerBytes, sizeof(TermDirectoryFooter));
+        return (memcmp(footer.magic, TermDirectoryMagic, sizeof(TermDirectoryMagic)) == 0) &&
+               (footer.version == TermDirectoryVersion) &&
+               (footer.directoryOffset <= (fileSize - sizeof(TermDirectoryFooter)));
+    }
+
+    bool has_term_directory(const char *path)
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!stream.is_open())
+            return false;
+        const auto fileSize = static_cast<size_t>(stream.tellg());
+        if (fileSize < sizeof(TermDirectoryFooter))
+            return false;
+        char footerBytes[sizeof(TermDirectoryFooter)];
+        stream.seekg(fileSize - sizeof(TermDirectoryFooter));
+        TermDirectoryFooter footer{};
+        return stream.read(footerBytes, sizeof(footerBytes)) && read_footer(footerBytes, fileSize, footer);
+    }
+
+    bool read_term_directory(const char *data, const size_t size, std::vector<TermDirectoryEntry> &entries)
+    {
+        TermDirectoryFooter footer{};
+        if ((size < sizeof(TermDirectoryFooter)) || !read_footer(data + size - sizeof(TermDirectoryFooter), size, footer))
+            return false;
+
+        const size_t directoryEnd = size - sizeof(TermDirectoryFooter);
+        size_t offset = footer.directoryOffset;
+        entries.clear();
+        entries.reserve(footer.termCount);
+        for (azgra::u64 i = 0; i < footer.termCount; ++i)
+        {
+            if ((offset + sizeof(azgra::u32)) > directoryEnd)
+                return false;
+            const auto termLength = read_value<azgra::u32>(data, offset);
+            if ((offset + termLength + sizeof(azgra::u64) + sizeof(azgra::u32)) > directoryEnd)
+                return false;
+            TermDirectoryEntry entry{};
+            entry.term = std::string_view(data + offset, termLength);
+            offset += termLength;
+            entry.postingsOffset = read_value<azgra::u64>(data, offset);
+            entry.postingCount = read_value<azgra::u32>(data, offset);
+            entries.push_back(entry);
+        }
+        return (offset == directoryEnd);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    /// Footer of the term directory appended to the compressed index files. Readers of the terms ignore everything after
+    /// the last term, so the files stay readable by the eager loading.
+    struct TermDirectoryFooter
+    {
+        /// Byte offset of the first directory entry.
+        azgra::u64 directoryOffset;
+        azgra::u64 termCount;
+        char magic[4];
+        azgra::u32 version;
+    };
+    static_assert(sizeof(TermDirectoryFooter) == 24, "Term directory footer must keep its size.");
+
+    constexpr char TermDirectoryMagic[4] = {'T', 'D', 'A', 'D'};
+    constexpr azgra::u32 TermDirectoryVersion = 1;
+
+    /// Where the postings of one term start in the compressed index.
+    struct TermDirectoryEntry
+    {
+        std::string_view term;
+        /// Bit offset of the Fibonacci codes or byte offset of the codec coded deltas.
+        azgra::u64 postingsOffset;
+        azgra::u32 postingCount;
+    };
+
+    /// Collects the directory entries, every entry is the term length, its bytes, postings offset and posting count.
+    class TermDirectoryWriter
+    {
+    private:
+        std::vector<azgra::byte> m_entries;
+        azgra::u64 m_termCount = 0;
+
+    public:
+        void add_term(const std::string_view &term, const azgra::u64 postingsOffset, const size_t postingCount);
+
+        /// Add all entries of the other directory with their postings offsets moved by the base.
+        void append(const TermDirectoryWriter &other, const azgra::u64 offsetBase);
+
+        /// Append the directory and its footer to the index bytes.
+        /// \param buffer Index bytes.
+        /// \param bufferOffset Byte offset of the buffer in the index file.
+        void append_to(std::vector<azgra::byte> &buffer, const azgra::u64 bufferOffset = 0) const;
+    };
+
+    /// Check whether the file ends with the term directory footer.
+    bool has_term_directory(const char *path);
+
+    /// Read the directory of the index file, terms view the given data.
+    /// \param data Whole index file.
+    /// \param size Size of the file.
+    /// \param entries Directory entries in the order of the terms in the file.
+    /// \return False if the file has no valid directory.
+    bool read_term_directory(const char *data, const size_t size, std::vector<TermDirectoryEntry> &entries);
+}
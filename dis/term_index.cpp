@@ -0,0 +1,188 @@
+#include "term_index.h"
+#include <algorithm>
+
+namespace dis
+{
+    DocumentPositions::DocumentPositions(const DocId id, const azgra::u32 *positions, const size_t count) : docId(id)
+    {
+        encodedPositions.reserve(count);
+        azgra::u32 previous = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            write_varint(encodedPositions, positions[i] - previous);
+            previous = positions[i];
+        }
+        encodedPositions.shrink_to_fit();
+    }
+
+    std::vector<azgra::u32> DocumentPositions::decode() const
+    {
+        std::vector<azgra::u32> positions;
+        const azgra::byte *it = encodedPositions.data();
+        const azgra::byte *end = it + encodedPositions.size();
+        azgra::u32 previous = 0;
+        while (it < end)
+        {
+            previous += read_varint(it);
+            positions.push_back(previous);
+        }
+        return positions;
+    }
+
+    TermIndex::TermIndex() : m_dictionary(std::make_shared<TermDictionary>())
+    {
+    }
+
+    TermIndex::TermIndex(std::shared_ptr<TermDictionary> dictionary, const bool positional) : m_dictionary(std::move(dictionary)),
+                                                                                               m_positional(positional)
+    {
+    }
+
+    std::set<DocumentOccurence> &TermIndex::get_or_create_postings(const TermId termId)
+    {
+        always_assert(termId < m_dictionary->size());
+        if (termId >= m_postings.size())
+        {
+            m_postings.resize(m_dictionary->size());
+        }
+        auto &postings = m_postings[termId];
+        if (postings.empty())
+        {
+            ++m_termCount;
+        }
+        return postings;
+    }
+
+    void TermIndex::add_occurence(const TermId termId, const DocumentOccurence &occurence)
+    {
+        get_or_create_postings(termId).insert(occurence);
+    }
+
+    void TermIndex::add_occurence(const TermId termId, const DocId docId, const azgra::u32 *positions, const size_t count)
+    {
+        add_occurence(termId, DocumentOccurence(docId, count));
+        if (!m_positional)
+            return;
+
+        if (termId >= m_positions.size())
+        {
+            m_positions.resize(m_dictionary->size());
+        }
+        auto &termPositions = m_positions[termId];
+        termPositions.emplace_back(docId, positions, count);
+        m_positionCount += count;
+        // Documents usually come in DocId order, only the parallel builds need to restore it.
+        if ((termPositions.size() > 1) && (termPositions[termPositions.size() - 2].docId > docId))
+        {
+            std::inplace_merge(termPositions.begin(), termPositions.end() - 1, termPositions.end());
+        }
+    }
+
+    void TermIndex::add_occurencies(const TermId termId, const std::set<DocumentOccurence> &occurencies)
+    {
+        if (occurencies.empty())
+            return;
+        get_or_create_postings(termId).insert(occurencies.begin(), occurencies.end());
+    }
+
+    void TermIndex::merge(const TermIndex &other)
+    {
+        always_assert(m_dictionary == other.m_dictionary && "Merged indices must share the term dictionary.");
+        for (TermId termId = 0; termId < other.m_postings.size(); ++termId)
+        {
+            add_occurencies(termId, other.m_postings[termId]);
+        }
+        if (!m_positional)
+            return;
+
+        if (m_positions.size() < other.m_positions.size())
+        {
+            m_positions.resize(other.m_positions.size());
+        }
+        for (TermId termId = 0; termId < other.m_positions.size(); ++termId)
+        {
+            auto &termPositions = m_positions[termId];
+            const size_t previousSize = termPositions.size();
+            termPositions.insert(termPositions.end(), other.m_positions[termId].begin(), other.m_positions[termId].end());
+            std::inplace_merge(termPositions.begin(), termPositions.begin() + previousSize, termPositions.end());
+        }
+        m_positionCount += other.m_positionCount;
+    }
+
+    const std::set<DocumentOccurence> &TermIndex::get_postings(const TermId termId) const
+    {
+        static const std::set<DocumentOccurence> noPostings;
+        return (termId < m_postings.size()) ? m_postings[termId] : noPostings;
+    }
+
+    const std::set<DocumentOccurence> *TermIndex::find_postings(const std::string_view &term) const
+    {
+        const TermId termId = m_dictionary->find(term);
+        if ((termId == TermDictionary::InvalidTermId) || (termId >= m_postings.size()) || m_postings[termId].empty())
+            return nullptr;
+        return &m_postings[termId];
+    }
+
+    const std::vector<DocumentPositions> &TermIndex::get_document_positions(const TermId termId) const
+    {
+        static const std::vector<DocumentPositions> noPositions;
+        return (termId < m_positions.size()) ? m_positions[termId] : noPositions;
+    }
+
+    std::vector<azgra::u32> TermIndex::get_positions(const TermId termId, const DocId docId) const
+    {
+        const auto &termPositions = get_document_positions(termId);
+        const auto it = std::lower_bound(termPositions.begin(), termPositions.end(), docId,
+                                         [](const DocumentPositions &positions, const DocId id)
+                                         { return positions.docId < id; });
+        if ((it == termPositions.end()) || (it->docId != docId))
+            return {};
+        return it->decode();
+    }
+
+    IndexMemoryReport TermIndex::get_memory_report() const
+    {
+        // Red-black tree node carries color and three pointers besides the value.
+        constexpr size_t SetNodeOverhead = 32;
+
+        IndexMemoryReport report = {};
+        report.termCount = m_termCount;
+        report.postingBytes = m_postings.capacity() * sizeof(std::set<DocumentOccurence>);
+        for (const auto &postings : m_postings)
+        {
+            report.postingCount += postings.size();
+        }
+        report.postingBytes += report.postingCount * (sizeof(DocumentOccurence) + SetNodeOverhead);
+
+        report.positionCount = m_positionCount;
+        report.positionBytes = m_positions.capacity() * sizeof(std::vector<DocumentPositions>);
+        for (const auto &termPositions : m_positions)
+        {
+            report.positionBytes += termPositions.capacity() * sizeof(DocumentPositions);
+            for (const auto &documentPositions : termPositions)
+            {
+                report.positionBytes += documentPositions.encodedPositions.capacity();
+            }
+        }
+        return report;
+    }
+
+    std::vector<TermId> TermIndex::get_sorted_term_ids() const
+    {
+        auto termIds = m_dictionary->get_sorted_term_ids();
+        termIds.erase(std::remove_if(termIds.begin(), termIds.end(), [this](const TermId termId)
+        {
+            return get_postings(termId).empty();
+        }), termIds.end());
+        return termIds;
+    }
+
+    void TermIndex::clear()
+    {
+        m_dictionary = std::make_shared<TermDictionary>();
+        m_postings.clear();
+        m_termCount = 0;
+        m_positions.clear();
+        m_positionCount = 0;
+    }
+}
@@ -2,8 +2,11 @@
 
 #include <azgra/string/smart_string_view.h>
 #include <map>
+#include <memory>
 #include <string>
 #include <set>
+#include "term_dictionary.h"
+#include "varint.h"
 
 namespace dis
 {
@@ -18,7 +21,6 @@ namespace dis
 
         explicit DocumentOccurence(const DocId id, const size_t count) : docId(id), occurenceCount(count)
         {
-            occurenceCount = 1;
         }
 
         bool operator<(const DocumentOccurence &other) const
@@ -33,16 +35,126 @@ namespace dis
 
     };
 
+    /// Token positions of a term in one document, delta encoded as variable byte integers.
+    struct DocumentPositions
+    {
+        DocId docId = 0;
+        std::vector<azgra::byte> encodedPositions;
+
+        DocumentPositions() = default;
+
+        DocumentPositions(const DocId id, const azgra::u32 *positions, const size_t count);
+
+        [[nodiscard]] std::vector<azgra::u32> decode() const;
+
+        bool operator<(const DocumentPositions &other) const
+        {
+            return (docId < other.docId);
+        }
+    };
+
+    struct IndexMemoryReport
+    {
+        size_t termCount = 0;
+        size_t postingCount = 0;
+        size_t postingBytes = 0;
+        size_t positionCount = 0;
+        size_t positionBytes = 0;
+    };
+
+    /// Inverted index with postings stored by TermId. Indices created from the same dictionary share TermIds, so they can be
+    /// merged without comparing any strings.
+    class TermIndex
+    {
+    private:
+        std::shared_ptr<TermDictionary> m_dictionary;
+        std::vector<std::set<DocumentOccurence>> m_postings;
+        size_t m_termCount = 0;
+        bool m_positional = false;
+        /// Positions of every term ordered by DocId, filled only in positional mode.
+        std::vector<std::vector<DocumentPositions>> m_positions;
+        size_t m_positionCount = 0;
+
+        std::set<DocumentOccurence> &get_or_create_postings(const TermId termId);
+
+    public:
+        TermIndex();
+
+        explicit TermIndex(std::shared_ptr<TermDictionary> dictionary, const bool positional = false);
+
+        void add_occurence(const TermId termId, const DocumentOccurence &occurence);
+
+        /// Add occurence with the token positions of the term in the document. Positions are stored only in positional mode.
+        /// \param termId Term.
+        /// \param docId Document.
+        /// \param positions Ascending token positions, their count is the term frequency.
+        /// \param count Number of positions.
+        void add_occurence(const TermId termId, const DocId docId, const azgra::u32 *positions, const size_t count);
 
-    typedef std::map<std::string, std::set<DocumentOccurence>> TermIndex;
+        void add_occurencies(const TermId termId, const std::set<DocumentOccurence> &occurencies);
+
+        /// Add all postings of the other index, which must use the same dictionary.
+        void merge(const TermIndex &other);
+
+        /// Get postings of the term, empty set if the term has no postings.
+        [[nodiscard]] const std::set<DocumentOccurence> &get_postings(const TermId termId) const;
+
+        /// Find postings of the term.
+        /// \return Postings or nullptr if the term isn't in the index.
+        [[nodiscard]] const std::set<DocumentOccurence> *find_postings(const std::string_view &term) const;
+
+        /// Get token positions of the term in the document, empty if the index isn't positional.
+        [[nodiscard]] std::vector<azgra::u32> get_positions(const TermId termId, const DocId docId) const;
+
+        /// Get positions of the term in all its documents, ordered by DocId.
+        [[nodiscard]] const std::vector<DocumentPositions> &get_document_positions(const TermId termId) const;
+
+        /// Estimate memory used by the postings and by the positions.
+        [[nodiscard]] IndexMemoryReport get_memory_report() const;
+
+        /// Get ids of the terms with postings, ordered by the terms.
+        [[nodiscard]] std::vector<TermId> get_sorted_term_ids() const;
+
+        /// Upper bound of the TermIds which can have postings.
+        [[nodiscard]] TermId get_term_id_limit() const
+        { return static_cast<TermId>(m_postings.size()); }
+
+        [[nodiscard]] TermDictionary &get_dictionary()
+        { return *m_dictionary; }
+
+        [[nodiscard]] const TermDictionary &get_dictionary() const
+        { return *m_dictionary; }
+
+        [[nodiscard]] const std::shared_ptr<TermDictionary> &get_shared_dictionary() const
+        { return m_dictionary; }
+
+        /// Number of terms with postings.
+        [[nodiscard]] size_t size() const
+        { return m_termCount; }
+
+        [[nodiscard]] bool empty() const
+        { return (m_termCount == 0); }
+
+        [[nodiscard]] bool is_positional() const
+        { return m_positional; }
+
+        /// Remove all postings and start with new dictionary. The old dictionary stays valid for its other users.
+        /// Positional mode is kept.
+        void clear();
+    };
 
     inline bool is_term(const azgra::string::SmartStringView<char> &str)
     {
         return ((str.length() > 2) && (!str.is_number()));
     }
 
+    inline bool is_term(const char *word, const size_t length)
+    {
+        return (length > 2) && is_term(azgra::string::SmartStringView<char>(word, length));
+    }
+
     struct QueryResult
     {
         std::set<DocId> documents;
     };
-}
\ No newline at end of file
+}
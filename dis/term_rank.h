@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string_view>
+
+namespace dis
+{
+    constexpr size_t TermNotFound = static_cast<size_t>(-1);
+
+    /// Find rank of the term by binary search in the sorted term table.
+    /// \param termCount Number of terms in the table.
+    /// \param getTerm Function returning the term of the rank.
+    /// \return Rank of the term or TermNotFound.
+    template<typename GetTerm>
+    size_t find_term_rank(const std::string_view &term, const size_t termCount, GetTerm &&getTerm)
+    {
+        size_t low = 0;
+        size_t high = termCount;
+        while (low < high)
+        {
+            const size_t middle = low + ((high - low) / 2);
+            if (getTerm(middle) < term)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return ((low < termCount) && (getTerm(low) == term)) ? low : TermNotFound;
+    }
+}
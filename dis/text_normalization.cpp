@@ -0,0 +1,290 @@
+#include "text_normalization.h"
+#include <random>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DIS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace dis
+{
+    typedef size_t (*NormalizeFn)(const char *src, const size_t length, char *dst);
+
+    static size_t normalize_scalar(const char *src, const size_t length, char *dst)
+    {
+        size_t outLength = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            const char c = CharacterTable[static_cast<azgra::byte>(src[i])];
+            dst[outLength] = c;
+            outLength += (c != 0);
+        }
+        return outLength;
+    }
+
+#if DIS_X86_SIMD
+
+    /// Shuffle masks moving the bytes selected by 8-bit mask to the front.
+    struct LeftPackTable
+    {
+        alignas(16) azgra::byte shuffle[256][8]{};
+
+        constexpr LeftPackTable()
+        {
+            for (int mask = 0; mask < 256; ++mask)
+            {
+                int out = 0;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    if (mask & (1 << bit))
+                        shuffle[mask][out++] = static_cast<azgra::byte>(bit);
+                }
+                for (; out < 8; ++out)
+                    shuffle[mask][out] = 0x80;
+            }
+        }
+    };
+
+    static constexpr LeftPackTable PackTable = {};
+
+    __attribute__((target("sse4.1")))
+    static inline __m128i in_range_sse(const __m128i c, const char low, const char high)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(static_cast<char>(low - 1))),
+                             _mm_cmplt_epi8(c, _mm_set1_epi8(static_cast<char>(high + 1))));
+    }
+
+    /// Write bytes of the vector selected by the 16-bit mask to dst, return number of written bytes.
+    /// Each half is stored as 8 bytes, which never reaches past the consumed input, so in place normalization is safe.
+    __attribute__((target("sse4.1")))
+    static inline size_t left_pack_16(const __m128i mapped, const unsigned mask, char *dst)
+    {
+        const unsigned lowMask = mask & 0xFFu;
+        const unsigned highMask = (mask >> 8) & 0xFFu;
+        const __m128i lowShuffle = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(PackTable.shuffle[lowMask]));
+        const __m128i highShuffle = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(PackTable.shuffle[highMask]));
+
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(mapped, lowShuffle));
+        const size_t lowCount = __builtin_popcount(lowMask);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + lowCount), _mm_shuffle_epi8(_mm_srli_si128(mapped, 8), highShuffle));
+        return lowCount + __builtin_popcount(highMask);
+    }
+
+    /// Uses pshufb (SSSE3) for the left packing and pblendvb (SSE4.1) for the separators, SSE4.1 implies both.
+    __attribute__((target("sse4.1")))
+    static size_t normalize_sse41(const char *src, const size_t length, char *dst)
+    {
+        const __m128i caseOffset = _mm_set1_epi8('a' - 'A');
+        const __m128i spaces = _mm_set1_epi8(' ');
+        size_t outLength = 0;
+        size_t i = 0;
+        for (; (i + 16) <= length; i += 16)
+        {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const __m128i upper = in_range_sse(c, 'A', 'Z');
+            const __m128i kept = _mm_or_si128(_mm_or_si128(in_range_sse(c, 'a', 'z'), in_range_sse(c, '0', '9')),
+                                              _mm_or_si128(_mm_cmpeq_epi8(c, spaces), _mm_cmpeq_epi8(c, _mm_set1_epi8('\n'))));
+            const __m128i separator = _mm_or_si128(
+                    _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('<')), _mm_cmpeq_epi8(c, _mm_set1_epi8('>'))),
+                                 _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\\')))),
+                    _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('.')), _mm_cmpeq_epi8(c, _mm_set1_epi8('-'))));
+
+            __m128i mapped = _mm_add_epi8(c, _mm_and_si128(upper, caseOffset));
+            mapped = _mm_blendv_epi8(mapped, spaces, separator);
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(kept, upper), separator)));
+
+            if (mask == 0xFFFFu)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + outLength), mapped);
+                outLength += 16;
+            }
+            else
+            {
+                outLength += left_pack_16(mapped, mask, dst + outLength);
+            }
+        }
+        return outLength + normalize_scalar(src + i, length - i, dst + outLength);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i in_range_avx(const __m256i c, const char low, const char high)
+    {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(static_cast<char>(low - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), c));
+    }
+
+    __attribute__((target("avx2")))
+    static size_t normalize_avx2(const char *src, const size_t length, char *dst)
+    {
+        const __m256i caseOffset = _mm256_set1_epi8('a' - 'A');
+        const __m256i spaces = _mm256_set1_epi8(' ');
+        size_t outLength = 0;
+        size_t i = 0;
+        for (; (i + 32) <= length; i += 32)
+        {
+            const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i upper = in_range_avx(c, 'A', 'Z');
+            const __m256i kept = _mm256_or_si256(
+                    _mm256_or_si256(in_range_avx(c, 'a', 'z'), in_range_avx(c, '0', '9')),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(c, spaces), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))));
+            const __m256i separator = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('<')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('>'))),
+                                    _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\')))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('.')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-'))));
+
+            __m256i mapped = _mm256_add_epi8(c, _mm256_and_si256(upper, caseOffset));
+            mapped = _mm256_blendv_epi8(mapped, spaces, separator);
+            const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(kept, upper), separator)));
+
+            if (mask == 0xFFFFFFFFu)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + outLength), mapped);
+                outLength += 32;
+            }
+            else
+            {
+                outLength += left_pack_16(_mm256_castsi256_si128(mapped), mask & 0xFFFFu, dst + outLength);
+                outLength += left_pack_16(_mm256_extracti128_si256(mapped, 1), mask >> 16, dst + outLength);
+            }
+        }
+        return outLength + normalize_sse41(src + i, length - i, dst + outLength);
+    }
+
+#endif
+
+    bool is_normalization_kernel_supported(const NormalizationKernel kernel)
+    {
+        switch (kernel)
+        {
+            case NormalizationKernel::Auto:
+            case NormalizationKernel::Scalar:
+                return true;
+#if DIS_X86_SIMD
+            case NormalizationKernel::SSE41:
+                return __builtin_cpu_supports("sse4.1");
+            case NormalizationKernel::AVX2:
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.1");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    static NormalizeFn select_normalize_function(const NormalizationKernel kernel)
+    {
+#if DIS_X86_SIMD
+        switch (kernel)
+        {
+            case NormalizationKernel::Auto:
+                if (is_normalization_kernel_supported(NormalizationKernel::AVX2))
+                    return normalize_avx2;
+                if (is_normalization_kernel_supported(NormalizationKernel::SSE41))
+                    return normalize_sse41;
+                return normalize_scalar;
+            case NormalizationKernel::SSE41:
+                return normalize_sse41;
+            case NormalizationKernel::AVX2:
+                return normalize_avx2;
+            default:
+                break;
+        }
+#endif
+        return normalize_scalar;
+    }
+
+    size_t normalize_text(const char *src, const size_t length, char *dst, const NormalizationKernel kernel)
+    {
+        if (kernel == NormalizationKernel::Auto)
+        {
+            static const NormalizeFn autoNormalize = select_normalize_function(NormalizationKernel::Auto);
+            return autoNormalize(src, length, dst);
+        }
+        always_assert(is_normalization_kernel_supported(kernel) && "Normalization kernel isn't supported by this CPU.");
+        return select_normalize_function(kernel)(src, length, dst);
+    }
+
+    /// Reference implementation with the character rules of the original ReutersArticle::filter_line.
+    static std::string reference_normalization(const std::string &text)
+    {
+        std::string result;
+        for (const char c : text)
+        {
+            if ((c >= 'a' && c <= 'z') || (c == ' ') || (c >= '0' && c <= '9') || (c == '\n'))
+                result.push_back(c);
+            else if (c >= 'A' && c <= 'Z')
+                result.push_back(static_cast<char>(c + ('a' - 'A')));
+            else if (c == '<' || c == '>' || c == '/' || c == '\\' || c == '.' || c == '-')
+                result.push_back(' ');
+        }
+        return result;
+    }
+
+    static bool normalization_matches(const std::string &text, const NormalizationKernel kernel)
+    {
+        const std::string expected = reference_normalization(text);
+
+        std::string output(text.length(), '\0');
+        output.resize(normalize_text(text.data(), text.length(), output.data(), kernel));
+
+        std::string inPlace = text;
+        inPlace.resize(normalize_text(inPlace.data(), inPlace.length(), inPlace.data(), kernel));
+
+        return (output == expected) && (inPlace == expected);
+    }
+
+    void test_text_normalization()
+    {
+        std::string allBytes;
+        for (int c = 0; c < 256; ++c)
+        {
+            allBytes.push_back(static_cast<char>(c));
+        }
+
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> byteDistribution(0, 255);
+        std::uniform_int_distribution<size_t> lengthDistribution(0, 300);
+        const std::string textAlphabet = "ABCxyz019 <>/\\.-,;\"'&#\n\t\r";
+        std::uniform_int_distribution<size_t> alphabetDistribution(0, textAlphabet.length() - 1);
+
+        std::vector<std::string> samples = {"", allBytes, "Showers continued throughout the week in the Bahia cocoa zone."};
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::string randomBytes(lengthDistribution(generator), '\0');
+            std::string randomText(lengthDistribution(generator), '\0');
+            for (char &c : randomBytes)
+                c = static_cast<char>(byteDistribution(generator));
+            for (char &c : randomText)
+                c = textAlphabet[alphabetDistribution(generator)];
+            samples.push_back(randomBytes);
+            samples.push_back(randomText);
+        }
+
+        const std::pair<const char *, NormalizationKernel> kernels[] = {{"scalar", NormalizationKernel::Scalar},
+                                                                        {"sse4.1", NormalizationKernel::SSE41},
+                                                                        {"avx2",   NormalizationKernel::AVX2}};
+        for (const auto &[name, kernel] : kernels)
+        {
+            if (!is_normalization_kernel_supported(kernel))
+            {
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Yellow, "Normalization kernel %s isn't supported\n", name);
+                continue;
+            }
+            size_t failed = 0;
+            for (const auto &sample : samples)
+            {
+                failed += normalization_matches(sample, kernel) ? 0 : 1;
+            }
+            if (failed > 0)
+            {
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Red, "Normalization kernel %s failed %lu/%lu samples\n",
+                                       name, failed, samples.size());
+            }
+            else
+            {
+                azgra::print_colorized(azgra::ConsoleColor::ConsoleColor_Green, "Normalization kernel %s passed %lu samples\n",
+                                       name, samples.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    /// Create table with the output character of every input byte. Letters are lowercased, digits and space are kept,
+    /// `< > / \ . -` force word separation and everything else is dropped (zero). New line is kept, so text of multiple
+    /// lines can be normalized at once with the same result as normalizing line by line.
+    constexpr std::array<char, 256> create_character_table()
+    {
+        std::array<char, 256> table = {};
+        for (int c = 0; c < 256; ++c)
+        {
+            if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || (c == ' ') || (c == '\n'))
+                table[c] = static_cast<char>(c);
+            else if (c >= 'A' && c <= 'Z')
+                table[c] = static_cast<char>(c + ('a' - 'A'));
+            else if (c == '<' || c == '>' || c == '/' || c == '\\' || c == '.' || c == '-')
+                table[c] = ' ';
+        }
+        return table;
+    }
+
+    constexpr std::array<char, 256> CharacterTable = create_character_table();
+
+    enum class NormalizationKernel
+    {
+        Auto,
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    bool is_normalization_kernel_supported(const NormalizationKernel kernel);
+
+    /// Normalize the text with the rules of the CharacterTable. Output is never longer than the input and the normalization
+    /// can be done in place (src == dst).
+    /// \param src Input text.
+    /// \param length Length of the input text.
+    /// \param dst Output buffer of at least length bytes.
+    /// \param kernel Kernel to use, Auto selects the best one supported by the CPU.
+    /// \return Length of the normalized text.
+    size_t normalize_text(const char *src, const size_t length, char *dst,
+                          const NormalizationKernel kernel = NormalizationKernel::Auto);
+
+    void test_text_normalization();
+}
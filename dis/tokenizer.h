@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include "text_normalization.h"
+
+namespace dis
+{
+    /// Reusable normalization buffer of the calling thread, it only grows so it stops allocating after the longest text.
+    inline std::vector<char> &thread_token_buffer()
+    {
+        thread_local std::vector<char> buffer;
+        return buffer;
+    }
+
+    /// Normalize the text with the character table and call the token callback with every non-empty token and the line
+    /// callback after every new line character. Tokens are views into the thread buffer, they are valid only inside the callback.
+    /// \param text Text of one or more lines.
+    /// \param length Length of the text.
+    /// \param tokenCallback Callback called as tokenCallback(const char *token, size_t tokenLength).
+    /// \param lineEndCallback Callback called as lineEndCallback() for every new line character.
+    template<typename TokenCallback, typename LineEndCallback>
+    inline void tokenize_text(const char *text, const size_t length, TokenCallback &&tokenCallback, LineEndCallback &&lineEndCallback)
+    {
+        std::vector<char> &buffer = thread_token_buffer();
+        if (buffer.size() < length)
+        {
+            buffer.resize(length);
+        }
+
+        char *normalized = buffer.data();
+        const size_t normalizedLength = normalize_text(text, length, normalized);
+
+        size_t tokenStart = 0;
+        for (size_t i = 0; i < normalizedLength; ++i)
+        {
+            const char c = normalized[i];
+            if (c == ' ' || c == '\n')
+            {
+                if (i > tokenStart)
+                    tokenCallback(normalized + tokenStart, i - tokenStart);
+                tokenStart = i + 1;
+                if (c == '\n')
+                    lineEndCallback();
+            }
+        }
+        if (normalizedLength > tokenStart)
+        {
+            tokenCallback(normalized + tokenStart, normalizedLength - tokenStart);
+        }
+    }
+
+    /// Normalize the line with the character table and call the callback with every non-empty token.
+    /// \param line Line text.
+    /// \param length Length of the line.
+    /// \param callback Callback called as callback(const char *token, size_t tokenLength).
+    template<typename TokenCallback>
+    inline void tokenize_line(const char *line, const size_t length, TokenCallback &&callback)
+    {
+        tokenize_text(line, length, std::forward<TokenCallback>(callback), []()
+        {});
+    }
+}
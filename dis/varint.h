@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <azgra/azgra.h>
+
+namespace dis
+{
+    /// Append the value as variable byte integer, 7 bits per byte with the high bit set on all but the last byte.
+    inline void write_varint(std::vector<azgra::byte> &buffer, azgra::u32 value)
+    {
+        while (value >= 0x80u)
+        {
+            buffer.push_back(static_cast<azgra::byte>(value | 0x80u));
+            value >>= 7u;
+        }
+        buffer.push_back(static_cast<azgra::byte>(value));
+    }
+
+    /// Read variable byte integer and move the pointer behind it.
+    inline azgra::u32 read_varint(const azgra::byte *&data)
+    {
+        azgra::u32 value = 0;
+        azgra::u32 shift = 0;
+        azgra::byte b;
+        do
+        {
+            b = *data++;
+            value |= static_cast<azgra::u32>(b & 0x7Fu) << shift;
+            shift += 7;
+        } while (b & 0x80u);
+        return value;
+    }
+}
@@ -1,6 +1,6 @@
 #include <sstream>
 #include "vector_model.h"
-#include "porter_stemmer.h"
+#include "stem_cache.h"
 
 namespace dis
 {
@@ -12,6 +12,11 @@ namespace dis
         termDocumentInfos[occurence.docId] = TermDocumentInfo(occurence.occurenceCount);
     }
 
+    void TermInfo::calculate_inverse_document_frequency(const size_t documentCount)
+    {
+        invDocFreq = log10(static_cast<azgra::f32>(documentCount) / static_cast<azgra::f32>(termDocumentInfos.size()));
+    }
+
     void TermInfo::add_to_magnitudes(std::vector<float> &occurenceMagnitude, std::vector<float> &weightMagnitude) const
     {
         for (const auto &[key, value] : termDocumentInfos)
@@ -56,40 +61,85 @@ namespace dis
 
     ////////////////////////////// VectorModel implementation //////////////////////////////
 
-    VectorModel::VectorModel(const TermIndex &index, const size_t documentCount)
+    VectorModel::VectorModel(const FrozenTermIndex &index, const size_t documentCount)
     {
         m_documentCount = documentCount;
-        m_termCount = index.size();
+        m_dictionary = index.get_shared_dictionary();
         create_vector_model(index);
     }
 
-    void VectorModel::create_vector_model(const TermIndex &index)
+    void VectorModel::create_vector_model(const FrozenTermIndex &index)
     {
         initialize_term_info(index);
         normalize_model();
     }
 
-    void VectorModel::initialize_term_info(const TermIndex &index)
+    void VectorModel::initialize_term_info(const FrozenTermIndex &index)
+    {
+        m_terms.clear();
+        add_term_occurencies(index);
+        update_term_order();
+        calculate_term_weights();
+        fprintf(stdout, "Initialized vector model\n");
+        m_initialized = true;
+    }
+
+    void VectorModel::add_term_occurencies(const FrozenTermIndex &index)
     {
-        size_t totalTermOccurence;
-        for (const auto&[term, termOccurencies] : index)
+        for (size_t rank = 0; rank < index.size(); ++rank)
         {
-            totalTermOccurence = 0;
-            m_terms[term] = TermInfo();
-            TermInfo &termInfo = m_terms.at(term);
-            for (const auto &docOccurence : termOccurencies)
+            const TermId termId = index.get_term_id(rank);
+            if (termId >= m_terms.size())
+            {
+                m_terms.resize(index.get_shared_dictionary()->size());
+            }
+            TermInfo &termInfo = m_terms[termId];
+            const PostingList postings = index.get_postings(rank);
+            for (size_t i = 0; i < postings.size; ++i)
             {
-                if (docOccurence.occurenceCount > 0)
+                if (postings.frequencies[i] > 0)
                 {
-                    totalTermOccurence += docOccurence.occurenceCount;
-                    termInfo.add_document_occurence(docOccurence);
+                    termInfo.add_document_occurence(DocumentOccurence(postings.docIds[i], postings.frequencies[i]));
                 }
             }
-            termInfo.invDocFreq = log10(static_cast<azgra::f32>(m_documentCount) / static_cast<azgra::f32>(totalTermOccurence));
+        }
+    }
+
+    void VectorModel::calculate_term_weights()
+    {
+        for (auto &termInfo : m_terms)
+        {
+            if (termInfo.termDocumentInfos.empty())
+                continue;
+            termInfo.calculate_inverse_document_frequency(m_documentCount);
             termInfo.calculate_document_weights();
         }
-        fprintf(stdout, "Initialized vector model\n");
-        m_initialized = true;
+    }
+
+    void VectorModel::update_term_order()
+    {
+        m_termOrder.clear();
+        for (const TermId termId : m_dictionary->get_sorted_term_ids())
+        {
+            if ((termId < m_terms.size()) && !m_terms[termId].termDocumentInfos.empty())
+                m_termOrder.push_back(termId);
+        }
+        m_termCount = m_termOrder.size();
+    }
+
+    void VectorModel::add_documents(const FrozenTermIndex &deltaIndex, const size_t documentCount)
+    {
+        always_assert(can_add_documents(deltaIndex) && "Delta index must share the term dictionary of the model.");
+        always_assert(documentCount >= m_documentCount);
+
+        // Only the new postings are added. Document count changes the IDF of every term, so the weights and the
+        // normalization are recalculated from the counts already stored in the model, without going back to the index.
+        m_documentCount = documentCount;
+        add_term_occurencies(deltaIndex);
+        update_term_order();
+        calculate_term_weights();
+        normalize_model();
+        fprintf(stdout, "Added documents to vector model, document count: %lu, term count: %lu\n", m_documentCount, m_termCount);
     }
 
     void VectorModel::normalize_model()
@@ -98,14 +148,15 @@ namespace dis
         std::vector<float> occurenceMagnitude(m_documentCount + 1, 0.0);
         std::vector<float> weightMagnitude(m_documentCount + 1, 0.0);
 
-        for (const auto&[term, termInfo] : m_terms)
+        // Float sums depend on the order of the terms.
+        for (const TermId termId : m_termOrder)
         {
-            termInfo.add_to_magnitudes(occurenceMagnitude, weightMagnitude);
+            m_terms[termId].add_to_magnitudes(occurenceMagnitude, weightMagnitude);
         }
         fprintf(stdout, "Calculated magnitutes..\n");
-        for (auto&[term, termInfo] : m_terms)
+        for (const TermId termId : m_termOrder)
         {
-            termInfo.apply_normalization(occurenceMagnitude, weightMagnitude);
+            m_terms[termId].apply_normalization(occurenceMagnitude, weightMagnitude);
         }
         fprintf(stdout, "Applied normalization to vector model...\n");
     }
@@ -123,19 +174,23 @@ namespace dis
     }
 
     void VectorModel::evaluate_vector_query(std::vector<DocumentScore> &scores,
-                                            const std::vector<std::pair<std::string, azgra::f32>> &vectorQueryTerm) const
+                                            const std::vector<std::pair<TermId, azgra::f32>> &vectorQueryTerm,
+                                            const DocumentBitmap *documentFilter) const
     {
-        for (const auto &[term, termQueryValue] : vectorQueryTerm)
+        for (const auto &[termId, termQueryValue] : vectorQueryTerm)
         {
-            const TermInfo &termInfo = m_terms.at(term);
+            const TermInfo &termInfo = m_terms[termId];
             for (const auto &[docId, termDocInfo] : termInfo.termDocumentInfos)
             {
+                if ((documentFilter != nullptr) && !documentFilter->test(docId))
+                    continue;
                 scores[docId].score += (termDocInfo.normalizedWeight * termQueryValue);
             }
         }
     }
 
-    std::vector<DocId> VectorModel::query_documents(const azgra::BasicStringView<char> &queryTxt) const
+    std::vector<DocId> VectorModel::query_documents(const azgra::BasicStringView<char> &queryTxt,
+                                                    const DocumentBitmap *documentFilter) const
     {
         std::vector<DocId> result;
         azgra::string::SmartStringView queryText(queryTxt);
@@ -152,20 +207,29 @@ namespace dis
 
         const auto queryVector = create_normalized_query_vector(queryTxt);
 
-        std::vector<DocumentScore> documentScore(m_documentCount);
-        for (size_t docId = 0; docId < m_documentCount; docId++)
+        // NOTE(Moravec): DocId starts from 1 not from zero.
+        std::vector<DocumentScore> documentScore(m_documentCount + 1);
+        for (size_t docId = 0; docId <= m_documentCount; docId++)
         {
             documentScore[docId].documentId = docId;
         }
 
-        evaluate_vector_query(documentScore, queryVector);
+        evaluate_vector_query(documentScore, queryVector, documentFilter);
 
+        if (documentFilter != nullptr)
+        {
+            documentScore.erase(std::remove_if(documentScore.begin(), documentScore.end(),
+                                               [documentFilter](const DocumentScore &ds)
+                                               { return !documentFilter->test(ds.documentId); }),
+                                documentScore.end());
+        }
 
         std::sort(documentScore.begin(), documentScore.end(), std::greater<>());
 
         std::stringstream docStream;
-        result.resize(10);
-        for (int i = 0; i < 10; ++i)
+        const size_t resultCount = std::min<size_t>(10, documentScore.size());
+        result.resize(resultCount);
+        for (size_t i = 0; i < resultCount; ++i)
         {
             docStream << "Document: " << documentScore[i].documentId << " with score: " << documentScore[i].score << '\n';
             result[i] = documentScore[i].documentId;
@@ -221,10 +285,10 @@ namespace dis
         azgra::Matrix<float> termDocument_tf_mat(m_termCount, m_documentCount, 0.0);
         azgra::Matrix<float> termDocument_tfidf_mat(m_termCount, m_documentCount, 0.0);
 
-        size_t rowIndex = 0;
-        for (const auto&[term, termInfo] : m_terms)
+        // Rows follow the term order, so the dot products sum in the same order for any TermId assignment.
+        for (size_t row = 0; row < m_termOrder.size(); ++row)
         {
-            termInfo.fill_in_tf_matrices(rowIndex++, termDocument_tf_mat, termDocument_tfidf_mat);
+            m_terms[m_termOrder[row]].fill_in_tf_matrices(row, termDocument_tf_mat, termDocument_tfidf_mat);
         }
         fprintf(stdout, "Constructed term document matrices...\n");
         return std::make_pair(termDocument_tf_mat, termDocument_tfidf_mat);
@@ -233,7 +297,10 @@ namespace dis
     void VectorModel::save_most_similar_documents(const char *tfSimilarityFile) const
     {
         // Create document-term matrix.
-        const size_t termCount = m_terms.size();
+        const size_t termCount = azgra::collection::count_if(m_terms.begin(), m_terms.end(), [](const TermInfo &termInfo)
+        {
+            return !termInfo.termDocumentInfos.empty();
+        });
         always_assert(m_termCount == termCount);
 
         auto[termDocument_tf_mat, termDocument_tfidf_mat] = reconstruct_tf_matrices();
@@ -293,7 +360,7 @@ namespace dis
         clusterer.clusterize();
     }
 
-    std::vector<std::pair<std::string, azgra::f32>>
+    std::vector<std::pair<TermId, azgra::f32>>
     VectorModel::create_normalized_query_vector(const azgra::BasicStringView<char> &queryTxt) const
     {
         const auto keywords = azgra::string::SmartStringView(queryTxt).split(" ");
@@ -304,13 +371,21 @@ namespace dis
                                                                  });
         always_assert(correctKeywordCount <= keywords.size());
         const azgra::f32 denumerator = sqrt(static_cast<azgra::f32>(correctKeywordCount));
-        std::vector<std::pair<std::string, azgra::f32>> queryVector(correctKeywordCount);
-        int index = 0;
+        std::vector<std::pair<TermId, azgra::f32>> queryVector;
+        if (m_dictionary == nullptr)
+            return queryVector;
+        queryVector.reserve(correctKeywordCount);
+        std::string stemBuffer;
         for (const auto &keyword : keywords)
         {
-            const AsciiString str = stem_word(keyword.data(), keyword.length());
-            const std::string term = std::string(str.get_c_string());
-            queryVector[index++] = std::make_pair(term, (1.0f / denumerator));
+            if (keyword.is_empty())
+                continue;
+            const TermId termId = m_dictionary->find(cached_stem_word(keyword.data(), keyword.length(), stemBuffer));
+            // Terms missing in the model don't contribute to any document score.
+            if ((termId != TermDictionary::InvalidTermId) && (termId < m_terms.size()))
+            {
+                queryVector.emplace_back(termId, (1.0f / denumerator));
+            }
         }
         return queryVector;
     }
@@ -6,7 +6,8 @@
 #include <azgra/io/stream/in_binary_file_stream.h>
 #include <azgra/io/stream/in_binary_buffer_stream.h>
 #include <azgra/collection/enumerable.h>
-#include "term_index.h"
+#include "frozen_term_index.h"
+#include "article_metadata.h"
 #include "document_clusterer.h"
 namespace dis
 {
@@ -72,6 +73,8 @@ namespace dis
 
         void add_document_occurence(const DocumentOccurence &occurence);
 
+        void calculate_inverse_document_frequency(const size_t documentCount);
+
         void add_to_magnitudes(std::vector<float> &occurenceMagnitude, std::vector<float> &weightMagnitude) const;
 
         void apply_normalization(const std::vector<float> &occurenceMagnitude, const std::vector<float> &weightMagnitude);
@@ -87,20 +90,32 @@ namespace dis
     private:
         size_t m_documentCount;
         size_t m_termCount;
-        std::map<std::string, TermInfo> m_terms;
+        std::shared_ptr<const TermDictionary> m_dictionary;
+        /// Term rows indexed by TermId of the index dictionary.
+        std::vector<TermInfo> m_terms;
+        /// TermIds of the terms with documents ordered by their terms. TermIds depend on the order in which the terms were
+        /// first seen, sums over the terms go in this order so they don't change with the ingest order.
+        std::vector<TermId> m_termOrder;
         bool m_initialized = false;
 
-        void create_vector_model(const TermIndex &index);
+        void create_vector_model(const FrozenTermIndex &index);
+
+        void initialize_term_info(const FrozenTermIndex &index);
+
+        void add_term_occurencies(const FrozenTermIndex &index);
 
-        void initialize_term_info(const TermIndex &index);
+        void calculate_term_weights();
 
-        [[nodiscard]] std::vector<std::pair<std::string, float>>
+        void update_term_order();
+
+        [[nodiscard]] std::vector<std::pair<TermId, float>>
         create_normalized_query_vector(const azgra::BasicStringView<char> &queryTxt) const;
 
         [[nodiscard]] float dot(const azgra::Matrix<float> &mat, const size_t col1, const size_t col2) const;
 
         void
-        evaluate_vector_query(std::vector<DocumentScore> &scores, const std::vector<std::pair<std::string, float>> &vectorQueryTerm) const;
+        evaluate_vector_query(std::vector<DocumentScore> &scores, const std::vector<std::pair<TermId, float>> &vectorQueryTerm,
+                              const DocumentBitmap *documentFilter) const;
 
         void normalize_model();
 
@@ -114,9 +129,25 @@ namespace dis
     public:
         VectorModel() = default;
 
-        explicit VectorModel(const TermIndex &index, const size_t documentCount);
-
-        [[nodiscard]] std::vector<DocId> query_documents(const azgra::BasicStringView<char> &queryText) const;
+        explicit VectorModel(const FrozenTermIndex &index, const size_t documentCount);
+
+        /// Whether the documents of the delta index can be added to this model, the model must exist and use the same
+        /// dictionary. Otherwise the model has to be built from the merged index.
+        [[nodiscard]] bool can_add_documents(const FrozenTermIndex &deltaIndex) const
+        { return m_initialized && (m_dictionary == deltaIndex.get_shared_dictionary()); }
+
+        /// Add documents of the new files to the model. Inverse document frequencies and normalization are recalculated from
+        /// the stored term counts, so the result is the same as building the model from the merged index.
+        /// \param deltaIndex Index of the new documents only, see can_add_documents.
+        /// \param documentCount Document count including the new documents.
+        void add_documents(const FrozenTermIndex &deltaIndex, const size_t documentCount);
+
+        /// Find the best scoring documents for the query.
+        /// \param queryText Query terms.
+        /// \param documentFilter Optional bitmap of the allowed documents, see ArticleMetadataStore::evaluate_filter.
+        /// \return Ten best documents.
+        [[nodiscard]] std::vector<DocId> query_documents(const azgra::BasicStringView<char> &queryText,
+                                                         const DocumentBitmap *documentFilter = nullptr) const;
 
         void save_most_similar_documents(const char *tfSimilarityFile) const;
 
@@ -1,6 +1,11 @@
 #include "dis/SgmlFile.h"
 #include "dis/porter_stemmer.h"
 #include "dis/sgml_collection.h"
+#include "dis/benchmark.h"
+#include "dis/text_normalization.h"
+#include "dis/inplace_stemmer.h"
+#include "dis/postings_codec.h"
+#include "dis/fibonacci_coding.h"
 
 #define ReutersFiles { "/mnt/d/codes/git/tda/data/txtdata/reut2-000.sgm", \
                         "/mnt/d/codes/git/tda/data/txtdata/reut2-001.sgm", \
@@ -32,6 +37,7 @@ int main(int argc, char **argv)
 #if !DEBUG
     printf("RELEASE MODE\n");
 #endif
+    //dis::benchmark_sgml_tag_scanner("/mnt/d/codes/git/tda/data/txtdata/reut2-000.sgm");
     dis::SgmlFileCollection collection(ReutersFilesSmall);
     //dis::SgmlFileCollection collection({"/mnt/d/codes/git/tda/data/txtdata/reut2-021.sgm"});
     collection.load_and_preprocess_sgml_files("/mnt/d/codes/git/tda/data/txtdata/stopwords.txt");
@@ -70,6 +76,14 @@ int main(int argc, char **argv)
         return 0;
     }
     test_porter_stemmer();
+    dis::test_text_normalization();
+    dis::test_inplace_stemmer();
+    dis::test_postings_codecs();
+    dis::test_fibonacci_coding();
+    dis::test_compressed_term_index();
+    dis::test_parallel_term_index();
+    dis::test_add_files_after_load();
+    dis::test_sgml_article_reader();
 
     char *inputFile = const_cast<char *>("/mnt/d/codes/git/tda/data/txtdata/reut2-021.sgm");
     char *outputFile = const_cast<char *>("/mnt/d/codes/git/tda/data/txtdata/reut2-021.txt");